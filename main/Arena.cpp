@@ -0,0 +1,276 @@
+#include "Arena.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+const Direction ALL_DIRECTIONS[4] = { Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT };
+}
+
+// ArenaSnake Implementation
+void ArenaSnake::pushHead(std::int32_t cell) {
+    if (length == ring.size()) {
+        // Full: unroll into a ring twice the size, head first
+        std::vector<std::int32_t> grown(std::max<std::size_t>(ring.size() * 2, 8));
+        for (std::uint32_t i = 0; i < length; ++i) grown[i] = at(i);
+        ring.swap(grown);
+        headSlot = 0;
+    }
+    headSlot = headSlot == 0 ? static_cast<std::uint32_t>(ring.size()) - 1 : headSlot - 1;
+    ring[headSlot] = cell;
+    ++length;
+}
+
+// Arena Implementation
+Arena::Arena(int width, int height, std::size_t snakeCount, std::size_t fruitCount, unsigned threads)
+    : width(width)
+    , height(height)
+    , owner(static_cast<std::size_t>(width) * height, 0)
+    , fruitAt(static_cast<std::size_t>(width) * height, 0)
+    , claims(static_cast<std::size_t>(width) * height)
+    , fruits(std::max<std::size_t>(1, fruitCount), -1)
+    , snakes(std::min(snakeCount, capacity(width, height, fruitCount)))
+    , pool(threads) {
+    reset(0);
+}
+
+int Arena::sideFor(std::size_t snakeCount) {
+    return std::max(32, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(snakeCount) * CELLS_PER_SNAKE))));
+}
+
+std::size_t Arena::capacity(int width, int height, std::size_t fruitCount) {
+    const std::size_t cells = static_cast<std::size_t>(width) * height;
+    fruitCount = std::max<std::size_t>(1, fruitCount);
+    return cells > fruitCount ? (cells - fruitCount) / SPAWN_LENGTH : 0;
+}
+
+void Arena::reset(std::uint64_t seed) {
+    rng.seed(seed);
+    std::fill(owner.begin(), owner.end(), 0);
+    std::fill(fruitAt.begin(), fruitAt.end(), 0);
+    for (auto& claim : claims) claim.store(0, std::memory_order_relaxed);
+    stats = Stats();
+    aliveCount = 0;
+    for (std::size_t id = 0; id < snakes.size(); ++id) {
+        ArenaSnake& s = snakes[id];
+        s.alive = false;
+        s.length = 0;
+        s.score = 0;
+        SimRng mix(seed ^ (static_cast<std::uint64_t>(id + 1) * 0xD1B54A32D192ED03ull));
+        s.rng.seed(mix.next());
+        spawn(id);
+    }
+    std::fill(fruits.begin(), fruits.end(), -1);
+    for (std::size_t f = 0; f < fruits.size(); ++f) placeFruit(f);
+}
+
+bool Arena::spawn(std::size_t id) {
+    ArenaSnake& s = snakes[id];
+    for (int attempt = 0; attempt < PLACE_TRIES; ++attempt) {
+        const int x = static_cast<int>(rng.below(static_cast<std::uint32_t>(width)));
+        const int y = static_cast<int>(rng.below(static_cast<std::uint32_t>(height)));
+        const Direction dir = ALL_DIRECTIONS[rng.below(4)];
+        const Position step = directionVector(dir);
+        // Head at (x, y) with the body trailing behind it and a free cell ahead
+        bool clear = true;
+        for (int i = -1; i < SPAWN_LENGTH && clear; ++i) {
+            const int cx = x - step.x * i;
+            const int cy = y - step.y * i;
+            const int cell = cy * width + cx;
+            clear = inBounds(cx, cy) && owner[cell] == 0 && fruitAt[cell] == 0;
+        }
+        if (!clear) continue;
+
+        s.length = 0;
+        s.headSlot = 0;
+        for (int i = SPAWN_LENGTH - 1; i >= 0; --i) {
+            const int cell = (y - step.y * i) * width + (x - step.x * i);
+            s.pushHead(cell);
+            owner[cell] = static_cast<std::int32_t>(id) + 1;
+        }
+        s.direction = dir;
+        s.alive = true;
+        ++aliveCount;
+        ++stats.spawns;
+        return true;
+    }
+    return false;
+}
+
+bool Arena::placeFruit(std::size_t index) {
+    const std::uint32_t cells = static_cast<std::uint32_t>(owner.size());
+    auto take = [&](std::uint32_t cell) {
+        if (owner[cell] != 0 || fruitAt[cell] != 0) return false;
+        fruitAt[cell] = static_cast<std::int32_t>(index) + 1;
+        fruits[index] = static_cast<std::int32_t>(cell);
+        return true;
+    };
+    for (int attempt = 0; attempt < PLACE_TRIES; ++attempt) {
+        if (take(rng.below(cells))) return true;
+    }
+    // Crowded board: scan from a random start
+    const std::uint32_t start = rng.below(cells);
+    for (std::uint32_t k = 0; k < cells; ++k) {
+        if (take((start + k) % cells)) return true;
+    }
+    fruits[index] = -1;
+    return false;
+}
+
+bool Arena::contested(int x, int y, std::size_t id) const {
+    for (Direction dir : ALL_DIRECTIONS) {
+        const Position step = directionVector(dir);
+        if (!inBounds(x + step.x, y + step.y)) continue;
+        const int cell = (y + step.y) * width + x + step.x;
+        const std::int32_t occupant = owner[cell];
+        if (occupant != 0 && static_cast<std::size_t>(occupant - 1) != id && snakes[occupant - 1].head() == cell) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Direction Arena::decide(std::size_t id) {
+    ArenaSnake& s = snakes[id];
+    const int head = s.head();
+    const int hx = head % width;
+    const int hy = head / width;
+    const int target = fruits[id % fruits.size()];
+    Direction options[4];
+    std::uint32_t count = 0;
+    int best = 0;
+    for (Direction dir : ALL_DIRECTIONS) {
+        if (isOpposite(dir, s.direction)) continue;
+        const Position step = directionVector(dir);
+        const int nx = hx + step.x;
+        const int ny = hy + step.y;
+        if (!inBounds(nx, ny) || owner[ny * width + nx] != 0) continue;
+        if (policy == ArenaPolicy::GREEDY && target >= 0) {
+            // A cell another head could also enter ranks behind every other move
+            const int distance = std::abs(nx - target % width) + std::abs(ny - target / width) +
+                                 (contested(nx, ny, id) ? width + height : 0);
+            if (count == 0 || distance < best) {
+                best = distance;
+                count = 0;
+            } else if (distance > best) {
+                continue;
+            }
+        }
+        options[count++] = dir;
+    }
+    if (count == 0) return s.direction;
+    return options[count == 1 ? 0 : s.rng.below(count)];
+}
+
+void Arena::judge(std::size_t id) {
+    ArenaSnake& s = snakes[id];
+    if (!s.alive) return;
+    if (s.next < 0) {
+        s.death = WALL + 1;
+    } else if (claims[s.next].load(std::memory_order_relaxed) > 1) {
+        s.death = HEAD_ON + 1;
+    } else if (const std::int32_t occupant = owner[s.next]) {
+        // Only a tail that moves on this tick makes room
+        const ArenaSnake& other = snakes[occupant - 1];
+        if (other.eats || other.tail() != s.next) s.death = BODY + 1;
+    }
+}
+
+void Arena::vacate(std::size_t id) {
+    ArenaSnake& s = snakes[id];
+    if (s.next >= 0) claims[s.next].store(0, std::memory_order_relaxed);
+    if (!s.alive) return;
+    if (s.death) {
+        for (std::uint32_t i = 0; i < s.length; ++i) owner[s.at(i)] = 0;
+        s.length = 0;
+        s.alive = false;
+    } else if (!s.eats) {
+        owner[s.tail()] = 0;
+        s.popTail();
+    }
+}
+
+void Arena::enter(std::size_t id) {
+    ArenaSnake& s = snakes[id];
+    if (!s.alive) return;
+    s.pushHead(s.next);
+    owner[s.next] = static_cast<std::int32_t>(id) + 1;
+    if (s.eats) {
+        s.eatenFruit = fruitAt[s.next] - 1;
+        fruitAt[s.next] = 0;
+        ++s.score;
+    }
+}
+
+void Arena::refill() {
+    bool fruitMissing = false;
+    for (ArenaSnake& s : snakes) {
+        if (s.death) {
+            ++stats.moves;
+            ++stats.deaths[s.death - 1];
+            --aliveCount;
+        } else if (s.alive) {
+            ++stats.moves;
+        }
+        if (s.eatenFruit >= 0) {
+            ++stats.eaten;
+            fruitMissing |= !placeFruit(static_cast<std::size_t>(s.eatenFruit));
+        }
+    }
+    // Fruit that found no free cell earlier
+    if (fruitMissing || std::find(fruits.begin(), fruits.end(), -1) != fruits.end()) {
+        for (std::size_t f = 0; f < fruits.size(); ++f) {
+            if (fruits[f] < 0) placeFruit(f);
+        }
+    }
+    if (respawn && aliveCount < snakes.size()) {
+        for (std::size_t id = 0; id < snakes.size(); ++id) {
+            if (!snakes[id].alive) spawn(id);
+        }
+    }
+}
+
+void Arena::step() {
+    auto decidePhase = [this](std::size_t begin, std::size_t end) {
+        for (std::size_t id = begin; id < end; ++id) {
+            ArenaSnake& s = snakes[id];
+            s.next = -1;
+            s.eats = false;
+            s.death = 0;
+            s.eatenFruit = -1;
+            if (!s.alive) continue;
+            s.direction = decide(id);
+            const Position step = directionVector(s.direction);
+            const int nx = s.head() % width + step.x;
+            const int ny = s.head() / width + step.y;
+            if (!inBounds(nx, ny)) continue;
+            s.next = ny * width + nx;
+            s.eats = fruitAt[s.next] != 0;
+            claims[s.next].fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+    auto judgePhase = [this](std::size_t begin, std::size_t end) {
+        for (std::size_t id = begin; id < end; ++id) judge(id);
+    };
+    auto vacatePhase = [this](std::size_t begin, std::size_t end) {
+        for (std::size_t id = begin; id < end; ++id) vacate(id);
+    };
+    auto enterPhase = [this](std::size_t begin, std::size_t end) {
+        for (std::size_t id = begin; id < end; ++id) enter(id);
+    };
+    pool.run(snakes.size(), decidePhase);
+    pool.run(snakes.size(), judgePhase);
+    pool.run(snakes.size(), vacatePhase);
+    pool.run(snakes.size(), enterPhase);
+    refill();
+    ++stats.ticks;
+}
+
+std::uint64_t Arena::checksum() const {
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    auto mix = [&hash](std::uint64_t v) { hash = (hash ^ v) * 0x100000001B3ull; };
+    for (std::int32_t o : owner) mix(static_cast<std::uint32_t>(o));
+    for (std::int32_t f : fruitAt) mix(static_cast<std::uint32_t>(f));
+    for (const ArenaSnake& s : snakes) mix(s.score);
+    return hash;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+// Many snakes on one board, for arena mode and scaling benchmarks.
+//
+// Collisions go through a shared ownership grid (per cell: snake id + 1, or
+// 0 when empty), so judging a move is one lookup however many snakes there
+// are. A tick runs in phases, each finished before the next starts:
+//
+//   decide   (parallel)  each snake picks a direction from the board as it
+//                        was after the last tick and claims its next cell
+//   judge    (parallel)  a move dies on a wall, on a cell claimed by more
+//                        than one head, or on a body cell that is not a
+//                        tail leaving this tick
+//   vacate   (parallel)  movers that did not eat drop their tail; the dead
+//                        clear their whole body
+//   enter    (parallel)  survivors write their new head cell
+//   refill   (serial)    eaten fruit and dead snakes respawn, in id order
+//
+// A parallel phase only reads what earlier phases wrote and only writes
+// its own snakes' state or cells no other snake writes in that phase. The
+// one shared counter (claims per cell) is a commutative add. So a tick
+// comes out the same for any thread count, and a head-on collision is
+// resolved the same way every time: every head entering the cell dies.
+
+#include "SnakeSim.hpp"
+#include "PhasePool.hpp"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+enum class ArenaPolicy {
+    GREEDY,     // toward its assigned fruit, avoiding occupied cells and
+                // cells next to another head
+    RANDOM      // any move onto an empty cell
+};
+
+class ArenaSnake {
+private:
+    friend class Arena;
+    std::vector<std::int32_t> ring;     // body cells; doubles when full
+    std::uint32_t headSlot = 0;
+    std::uint32_t length = 0;
+    Direction direction = Direction::RIGHT;
+    SimRng rng;
+    bool alive = false;
+    std::uint32_t score = 0;
+
+    // Per-tick results, written by the phase named
+    std::int32_t next = -1;             // decide: next head cell, -1 off the board
+    bool eats = false;                  // decide
+    std::uint8_t death = 0;             // judge: 0 or an Arena::DeathCause + 1
+    std::int32_t eatenFruit = -1;       // enter: index into Arena::fruits
+
+    std::int32_t at(std::uint32_t i) const {
+        std::uint32_t slot = headSlot + i;
+        if (slot >= ring.size()) slot -= static_cast<std::uint32_t>(ring.size());
+        return ring[slot];
+    }
+    void pushHead(std::int32_t cell);
+    void popTail() { --length; }
+
+public:
+    // The ring starts sized, so head() of a snake that never spawned reads
+    // a cell rather than past an empty vector
+    ArenaSnake() : ring(8) {}
+    bool isAlive() const { return alive; }
+    // Where the snake is, or last was; only meaningful while isAlive()
+    std::int32_t head() const { return ring[headSlot]; }
+    std::int32_t tail() const { return at(length - 1); }
+    std::uint32_t getLength() const { return length; }
+    std::uint32_t getScore() const { return score; }
+    Direction getDirection() const { return direction; }
+};
+
+class Arena {
+public:
+    enum DeathCause { WALL, BODY, HEAD_ON, CAUSE_COUNT };
+
+    struct Stats {
+        std::uint64_t ticks = 0;
+        std::uint64_t moves = 0;        // snake-ticks of live snakes
+        std::uint64_t eaten = 0;
+        std::uint64_t deaths[CAUSE_COUNT] = {};
+        std::uint64_t spawns = 0;
+    };
+
+private:
+    int width;
+    int height;
+    std::vector<std::int32_t> owner;                // snake id + 1, 0 = empty
+    std::vector<std::int32_t> fruitAt;              // fruit index + 1, 0 = none
+    std::vector<std::atomic<std::uint8_t>> claims;  // heads entering each cell this tick
+    std::vector<std::int32_t> fruits;               // fruit cells; snake i targets fruit i % count
+    std::vector<ArenaSnake> snakes;
+    SimRng rng;                                     // refill phase only
+    ArenaPolicy policy = ArenaPolicy::GREEDY;
+    bool respawn = true;
+    std::size_t aliveCount = 0;
+    Stats stats;
+    PhasePool pool;
+
+    static const int SPAWN_LENGTH = 3;
+    static const int PLACE_TRIES = 32;
+
+    bool inBounds(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+    bool contested(int x, int y, std::size_t id) const;
+    Direction decide(std::size_t id);
+    void judge(std::size_t id);
+    void vacate(std::size_t id);
+    void enter(std::size_t id);
+    void refill();
+    bool spawn(std::size_t id);
+    bool placeFruit(std::size_t index);
+
+public:
+    // threads includes the caller. A board too small for fruitCount fruit
+    // and snakeCount fresh snakes gets only the snakes that fit.
+    Arena(int width, int height, std::size_t snakeCount, std::size_t fruitCount, unsigned threads = 1);
+    void reset(std::uint64_t seed);
+    void setPolicy(ArenaPolicy p) { policy = p; }
+    // Whether dead snakes re-enter at a random free spot (default true)
+    void setRespawn(bool enabled) { respawn = enabled; }
+    void step();
+
+    // Board side giving each snake about CELLS_PER_SNAKE cells
+    static const int CELLS_PER_SNAKE = 64;
+    static int sideFor(std::size_t snakeCount);
+    // Whether the fruit and every snake at its spawn length fit on the board
+    static bool fits(int width, int height, std::size_t snakeCount, std::size_t fruitCount) {
+        return snakeCount <= capacity(width, height, fruitCount);
+    }
+    // Most snakes that fit beside fruitCount fruit
+    static std::size_t capacity(int width, int height, std::size_t fruitCount);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    std::size_t getSnakeCount() const { return snakes.size(); }
+    std::size_t getAliveCount() const { return aliveCount; }
+    const ArenaSnake& getSnake(std::size_t id) const { return snakes[id]; }
+    // Snake id occupying a cell (y * width + x), or -1
+    int ownerAt(int cell) const { return owner[cell] - 1; }
+    bool hasFruit(int cell) const { return fruitAt[cell] != 0; }
+    const Stats& getStats() const { return stats; }
+    unsigned getThreadCount() const { return pool.size(); }
+    // Hash of the board, fruit and scores, for comparing runs
+    std::uint64_t checksum() const;
+};
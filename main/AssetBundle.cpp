@@ -0,0 +1,129 @@
+#include "AssetBundle.hpp"
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+const char MAGIC[4] = { 'S', 'N', 'K', 'B' };
+const std::uint32_t VERSION = 1;
+const size_t HEADER_SIZE = 16;
+const size_t ENTRY_FIXED_SIZE = 32;
+const size_t BLOB_ALIGN = 16;
+
+size_t alignUp(size_t v, size_t a) { return (v + a - 1) / a * a; }
+
+void putU32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+}
+
+void putU64(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+}
+
+std::uint32_t getU32(const std::uint8_t* p) {
+    std::uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+std::uint64_t getU64(const std::uint8_t* p) {
+    std::uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+} // namespace
+
+// AssetBundle Implementation
+bool AssetBundle::open(const std::string& path) {
+    close();
+    if (!file.open(path)) return false;
+    const std::uint8_t* bytes = file.data();
+    const size_t length = file.size();
+    if (length < HEADER_SIZE || std::memcmp(bytes, MAGIC, 4) != 0 || getU32(bytes + 4) != VERSION) {
+        close();
+        return false;
+    }
+
+    const std::uint32_t count = getU32(bytes + 8);
+    size_t offset = HEADER_SIZE;
+    std::vector<Entry> parsed;
+    parsed.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        if (length - offset < ENTRY_FIXED_SIZE) {
+            close();
+            return false;
+        }
+        const std::uint8_t* p = bytes + offset;
+        Entry entry;
+        entry.kind = static_cast<Kind>(getU32(p));
+        entry.meta[0] = getU32(p + 4);
+        entry.meta[1] = getU32(p + 8);
+        const std::uint32_t nameLength = getU32(p + 12);
+        const std::uint64_t blobOffset = getU64(p + 16);
+        entry.size = getU64(p + 24);
+        offset += ENTRY_FIXED_SIZE;
+        // The writer pads every name, so the padding must fit too; otherwise
+        // offset could pass length and the next check would wrap around
+        if (length - offset < alignUp(nameLength, 8) || blobOffset > length || entry.size > length - blobOffset) {
+            close();
+            return false;
+        }
+        entry.name.assign(reinterpret_cast<const char*>(bytes + offset), nameLength);
+        entry.data = bytes + blobOffset;
+        offset += alignUp(nameLength, 8);
+        parsed.push_back(std::move(entry));
+    }
+    entryList = std::move(parsed);
+    return true;
+}
+
+void AssetBundle::close() {
+    entryList.clear();
+    file.close();
+}
+
+const AssetBundle::Entry* AssetBundle::find(const std::string& name, Kind kind) const {
+    for (const Entry& entry : entryList) {
+        if (entry.kind == kind && entry.name == name) return &entry;
+    }
+    return nullptr;
+}
+
+// AssetBundleWriter Implementation
+void AssetBundleWriter::add(const std::string& name, AssetBundle::Kind kind, const void* data, std::uint64_t size,
+                            std::uint32_t meta0, std::uint32_t meta1) {
+    const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+    pending.push_back(Pending{ name, kind, { meta0, meta1 }, std::vector<std::uint8_t>(bytes, bytes + size) });
+}
+
+bool AssetBundleWriter::save(const std::string& path) const {
+    size_t indexSize = HEADER_SIZE;
+    for (const Pending& p : pending) indexSize += ENTRY_FIXED_SIZE + alignUp(p.name.size(), 8);
+
+    std::vector<std::uint8_t> out(MAGIC, MAGIC + 4);
+    putU32(out, VERSION);
+    putU32(out, static_cast<std::uint32_t>(pending.size()));
+    putU32(out, 0);
+    size_t blobOffset = alignUp(indexSize, BLOB_ALIGN);
+    for (const Pending& p : pending) {
+        putU32(out, p.kind);
+        putU32(out, p.meta[0]);
+        putU32(out, p.meta[1]);
+        putU32(out, static_cast<std::uint32_t>(p.name.size()));
+        putU64(out, blobOffset);
+        putU64(out, p.bytes.size());
+        out.insert(out.end(), p.name.begin(), p.name.end());
+        out.resize(alignUp(out.size(), 8), 0);
+        blobOffset = alignUp(blobOffset + p.bytes.size(), BLOB_ALIGN);
+    }
+    for (const Pending& p : pending) {
+        out.resize(alignUp(out.size(), BLOB_ALIGN), 0);
+        out.insert(out.end(), p.bytes.begin(), p.bytes.end());
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+// Single-file asset bundle, written offline by snake_pack and memory-mapped
+// at launch. Entries point straight into the mapping, so nothing is copied
+// until a consumer (SFML) needs its own copy.
+//
+//   "SNKB" | u32 version | u32 entryCount | u32 reserved
+//   entryCount x { u32 kind | u32 meta0 | u32 meta1 | u32 nameLength |
+//                  u64 offset | u64 size | name (padded to 8 bytes) }
+//   blobs, each starting on a 16-byte boundary
+//
+// All integers are little-endian. Entry kinds:
+//   RAW      bytes used as-is (fonts, streamed music)
+//   IMAGE    RGBA8 pixels; meta0 = width, meta1 = height
+//   SAMPLES  int16 PCM; meta0 = channel count, meta1 = sample rate
+
+#include "MappedFile.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class AssetBundle {
+public:
+    enum Kind : std::uint32_t { RAW = 0, IMAGE = 1, SAMPLES = 2 };
+
+    struct Entry {
+        std::string name;
+        Kind kind = RAW;
+        std::uint32_t meta[2] = { 0, 0 };
+        const std::uint8_t* data = nullptr;   // into the mapping
+        std::uint64_t size = 0;
+    };
+
+private:
+    MappedFile file;
+    std::vector<Entry> entryList;
+
+public:
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return !entryList.empty(); }
+    // nullptr if the bundle has no entry of that name and kind
+    const Entry* find(const std::string& name, Kind kind) const;
+    const std::vector<Entry>& entries() const { return entryList; }
+};
+
+class AssetBundleWriter {
+private:
+    struct Pending {
+        std::string name;
+        AssetBundle::Kind kind;
+        std::uint32_t meta[2];
+        std::vector<std::uint8_t> bytes;
+    };
+    std::vector<Pending> pending;
+
+public:
+    void add(const std::string& name, AssetBundle::Kind kind, const void* data, std::uint64_t size,
+             std::uint32_t meta0 = 0, std::uint32_t meta1 = 0);
+    bool save(const std::string& path) const;
+    size_t entryCount() const { return pending.size(); }
+};
@@ -0,0 +1,50 @@
+#include "Assets.hpp"
+#include <algorithm>
+
+namespace assets {
+
+// Box-filter resample used when packing large source images into atlas
+// tiles. Colour is alpha-weighted so transparent pixels don't darken edges.
+sf::Image scaleImage(const sf::Image& src, sf::Vector2u size) {
+    sf::Image dst(size, sf::Color::Transparent);
+    const sf::Vector2u srcSize = src.getSize();
+    if (srcSize.x == 0 || srcSize.y == 0) return dst;
+    const std::uint8_t* in = src.getPixelsPtr();
+    for (unsigned y = 0; y < size.y; ++y) {
+        unsigned y0 = y * srcSize.y / size.y;
+        unsigned y1 = std::max(y0 + 1, (y + 1) * srcSize.y / size.y);
+        for (unsigned x = 0; x < size.x; ++x) {
+            unsigned x0 = x * srcSize.x / size.x;
+            unsigned x1 = std::max(x0 + 1, (x + 1) * srcSize.x / size.x);
+            std::uint64_t r = 0, g = 0, b = 0, a = 0, n = 0;
+            for (unsigned sy = y0; sy < y1; ++sy) {
+                const std::uint8_t* px = in + (static_cast<size_t>(sy) * srcSize.x + x0) * 4;
+                for (unsigned sx = x0; sx < x1; ++sx, px += 4) {
+                    r += px[0] * px[3];
+                    g += px[1] * px[3];
+                    b += px[2] * px[3];
+                    a += px[3];
+                    ++n;
+                }
+            }
+            sf::Color c = sf::Color::Transparent;
+            if (a > 0) {
+                c = sf::Color(static_cast<std::uint8_t>(r / a), static_cast<std::uint8_t>(g / a),
+                              static_cast<std::uint8_t>(b / a), static_cast<std::uint8_t>(a / n));
+            }
+            dst.setPixel({x, y}, c);
+        }
+    }
+    return dst;
+}
+
+sf::Vector2u backgroundSize(sf::Vector2u source) {
+    if (source.x == 0 || source.y == 0) return source;
+    float scale = std::max(static_cast<float>(BACKGROUND_WIDTH) / source.x,
+                           static_cast<float>(BACKGROUND_HEIGHT) / source.y);
+    if (scale >= 1.f) return source;
+    return { std::max(1u, static_cast<unsigned>(source.x * scale + 0.5f)),
+             std::max(1u, static_cast<unsigned>(source.y * scale + 0.5f)) };
+}
+
+} // namespace assets
@@ -0,0 +1,39 @@
+#pragma once
+
+// Asset names and preprocessing shared by the game and snake_pack, so the
+// bundle is packed exactly the way the game would prepare loose files.
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+
+namespace assets {
+
+// Default bundle location, next to the loose assets/ directory
+const char* const BUNDLE_PATH = "assets.snkpak";
+const char* const ASSET_DIR = "assets";
+
+// Sprites are packed into square atlas tiles of this edge length
+const unsigned TILE_SIZE = 32;
+// The background is scaled to cover the game window (Game::WINDOW_WIDTH x
+// Game::WINDOW_HEIGHT); packing it larger than this only costs load time
+const unsigned BACKGROUND_WIDTH = 800;
+const unsigned BACKGROUND_HEIGHT = 600;
+
+// Bundle entry names. Fonts are stored as FONT_PREFIX + file name.
+const char* const HEAD_IMAGE = "img/head";
+const char* const BODY_IMAGE = "img/body";
+const char* const FRUIT_IMAGE = "img/fruit";
+const char* const BACKGROUND_IMAGE = "img/bg";
+const char* const EAT_SOUND = "sfx/eat";
+const char* const GAME_OVER_SOUND = "sfx/gameover";
+const char* const MOVE_SOUND = "sfx/move";
+const char* const MUSIC = "music/bgmusic";
+const char* const FONT_PREFIX = "font/";
+
+sf::Image scaleImage(const sf::Image& src, sf::Vector2u size);
+
+// Size that covers BACKGROUND_WIDTH x BACKGROUND_HEIGHT with the source's
+// aspect ratio, never larger than the source
+sf::Vector2u backgroundSize(sf::Vector2u source);
+
+} // namespace assets
@@ -0,0 +1,356 @@
+#include "Autopilot.hpp"
+#include "Bots.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+namespace {
+
+const Direction ALL_DIRECTIONS[4] = { Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT };
+
+Direction transposed(Direction dir) {
+    switch (dir) {
+        case Direction::UP:    return Direction::LEFT;
+        case Direction::DOWN:  return Direction::RIGHT;
+        case Direction::LEFT:  return Direction::UP;
+        case Direction::RIGHT: return Direction::DOWN;
+    }
+    return dir;
+}
+
+} // namespace
+
+std::vector<Direction> hamiltonianCycle(int width, int height) {
+    if (height % 2 == 0 && width >= 2) {
+        // Column 0 runs down; rows then alternate right/left over columns
+        // 1.. from the bottom up
+        std::vector<Direction> next(static_cast<size_t>(width) * height);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                Direction d;
+                if (x == 0) {
+                    d = y < height - 1 ? Direction::DOWN : Direction::RIGHT;
+                } else if ((height - 1 - y) % 2 == 0) {
+                    d = x < width - 1 ? Direction::RIGHT : Direction::UP;
+                } else {
+                    d = x > 1 || y == 0 ? Direction::LEFT : Direction::UP;
+                }
+                next[static_cast<size_t>(y) * width + x] = d;
+            }
+        }
+        return next;
+    }
+    if (width % 2 == 0 && height >= 2) {
+        // The same cycle on the transposed board
+        std::vector<Direction> flipped = hamiltonianCycle(height, width);
+        std::vector<Direction> next(flipped.size());
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                next[static_cast<size_t>(y) * width + x] = transposed(flipped[static_cast<size_t>(x) * height + y]);
+            }
+        }
+        return next;
+    }
+    return {};
+}
+
+void AutopilotStats::merge(const AutopilotStats& other) {
+    ticks += other.ticks;
+    searches += other.searches;
+    reused += other.reused;
+    fallbacks += other.fallbacks;
+    overBudget += other.overBudget;
+    totalNs += other.totalNs;
+    maxNs = std::max(maxNs, other.maxNs);
+}
+
+// AutopilotBot Implementation
+AutopilotBot::AutopilotBot(int width, int height)
+    : width(width)
+    , height(height)
+    , cycle(hamiltonianCycle(width, height)) {
+    const size_t cells = static_cast<size_t>(width) * height;
+    if (!cycle.empty()) {
+        cycleIndex.assign(cells, 0);
+        Position p(0, 0);
+        for (int i = 0; i < static_cast<int>(cells); ++i) {
+            cycleIndex[cellOf(p)] = i;
+            p = p + directionVector(cycle[cellOf(p)]);
+        }
+    }
+    freeAt.assign(cells, 0);
+    virtualFreeAt.assign(cells, 0);
+    parent.assign(cells, -1);
+    bestG.assign(cells, 0);
+    seen.assign(cells, 0);
+    // Each cell enters the heap at most once per neighbour
+    open.reserve(cells * 4);
+    virtualBody.reserve(cells + 1);
+    path.reserve(cells);
+    scratchPath.reserve(cells);
+}
+
+void AutopilotBot::reset() {
+    path.clear();
+    pathStep = 0;
+    pathFruit = -1;
+    expectedHead = -1;
+}
+
+Direction AutopilotBot::directionTo(int from, int to) const {
+    if (to == from + 1) return Direction::RIGHT;
+    if (to == from - 1) return Direction::LEFT;
+    return to > from ? Direction::DOWN : Direction::UP;
+}
+
+int AutopilotBot::cycleSpan(int from, int to) const {
+    const int span = cycleIndex[to] - cycleIndex[from];
+    return span < 0 ? span + static_cast<int>(cycleIndex.size()) : span;
+}
+
+bool AutopilotBot::bodyFollowsCycle(const SnakeBody& body) const {
+    if (cycle.empty()) return false;
+    // Walking back from the head, each segment must be further behind it
+    const int head = cellOf(body.front());
+    int behind = 0;
+    for (size_t i = 1; i < body.size(); ++i) {
+        const int span = cycleSpan(cellOf(body[i]), head);
+        if (span <= behind) return false;
+        behind = span;
+    }
+    return true;
+}
+
+int AutopilotBot::findPath(int start, int goal, const std::vector<int>& blocked, std::vector<int>* out,
+                           int arcEnd) {
+    if (++epoch == 0) {
+        std::fill(seen.begin(), seen.end(), 0);
+        epoch = 1;
+    }
+    const int goalX = goal % width;
+    const int goalY = goal / width;
+    auto heuristic = [&](int cell) { return std::abs(cell % width - goalX) + std::abs(cell / width - goalY); };
+    // Min-heap on f; on equal f prefer the deeper node, which reaches the
+    // goal with fewer expansions on an open board
+    auto after = [](const OpenNode& a, const OpenNode& b) { return a.f != b.f ? a.f > b.f : a.g < b.g; };
+
+    open.clear();
+    seen[start] = epoch;
+    bestG[start] = 0;
+    parent[start] = -1;
+    open.push_back(OpenNode{ heuristic(start), 0, start });
+    unsigned expanded = 0;
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), after);
+        const OpenNode node = open.back();
+        open.pop_back();
+        if (node.g != bestG[node.cell]) continue;   // superseded entry
+        if (node.cell == goal) {
+            if (out) {
+                out->resize(static_cast<size_t>(node.g));
+                for (int cell = goal, i = node.g; i > 0; cell = parent[cell]) (*out)[--i] = cell;
+            }
+            return node.g;
+        }
+        if (budget.count() && (++expanded & 63) == 0 && std::chrono::steady_clock::now() > deadline) {
+            outOfTime = true;
+            return -1;
+        }
+        const int x = node.cell % width;
+        const int y = node.cell / width;
+        const int neighbours[4] = {
+            y > 0 ? node.cell - width : -1,
+            y < height - 1 ? node.cell + width : -1,
+            x > 0 ? node.cell - 1 : -1,
+            x < width - 1 ? node.cell + 1 : -1,
+        };
+        const int g = node.g + 1;
+        for (int next : neighbours) {
+            // Body cells open up once the tail has passed them
+            if (next < 0 || blocked[next] > g) continue;
+            if (arcEnd > 0) {
+                const int ahead = cycleSpan(start, next);
+                if (ahead <= cycleSpan(start, node.cell) || ahead >= arcEnd) continue;
+            }
+            if (seen[next] == epoch && bestG[next] <= g) continue;
+            seen[next] = epoch;
+            bestG[next] = g;
+            parent[next] = node.cell;
+            open.push_back(OpenNode{ g + heuristic(next), g, next });
+            std::push_heap(open.begin(), open.end(), after);
+        }
+    }
+    return -1;
+}
+
+bool AutopilotBot::tailReachable(const SnakeBody& body, const int* steps, size_t count, bool grows,
+                                 int* routeLength) {
+    const size_t length = body.size() + (grows ? 1 : 0);
+    if (length >= freeAt.size()) return true;   // that move wins the game
+
+    // Body after the walk, head first: the steps reversed, then what is
+    // left of the current body
+    virtualBody.clear();
+    for (size_t i = count; i-- > 0 && virtualBody.size() < length;) virtualBody.push_back(steps[i]);
+    for (size_t i = 0; virtualBody.size() < length; ++i) virtualBody.push_back(cellOf(body[i]));
+    for (size_t i = 0; i < length; ++i) virtualFreeAt[virtualBody[i]] = static_cast<int>(length - i);
+    const int route = findPath(virtualBody.front(), virtualBody.back(), virtualFreeAt, nullptr);
+    for (int cell : virtualBody) virtualFreeAt[cell] = 0;
+    if (routeLength) *routeLength = route;
+    return route > 0;
+}
+
+bool AutopilotBot::planToFruit(const SnakeSim& sim, bool ordered) {
+    const SnakeBody body = sim.getSnake().getBody();
+    const size_t length = body.size();
+    const int head = cellOf(body.front());
+    const int fruit = cellOf(sim.getFruit().getPosition());
+    // An ordered body only takes shortcuts into the free arc before its tail
+    int arcEnd = 0;
+    if (ordered) {
+        arcEnd = cycleSpan(head, cellOf(body.back()));
+        if (cycleSpan(head, fruit) >= arcEnd) return false;
+    }
+    for (size_t i = 0; i < length; ++i) freeAt[cellOf(body[i])] = static_cast<int>(length - i);
+    const int steps = findPath(head, fruit, freeAt, &scratchPath, arcEnd);
+    for (const Position& p : body) freeAt[cellOf(p)] = 0;
+    if (steps <= 0 || !tailReachable(body, scratchPath.data(), scratchPath.size(), true, nullptr)) return false;
+    path.swap(scratchPath);
+    pathStep = 0;
+    return true;
+}
+
+Direction AutopilotBot::fallback(const SnakeSim& sim, bool ordered) {
+    const Snake& snake = sim.getSnake();
+    const SnakeBody body = snake.getBody();
+    const Position head = snake.getHead();
+    const int fruit = cellOf(sim.getFruit().getPosition());
+    auto keepsTail = [&](Direction dir, int* route) {
+        const int next = cellOf(head + directionVector(dir));
+        return tailReachable(body, &next, 1, next == fruit, route);
+    };
+
+    if (!cycle.empty()) {
+        const Direction dir = cycle[cellOf(head)];
+        if (isSafeMove(sim, dir) && (ordered || outOfTime || keepsTail(dir, nullptr))) return dir;
+    }
+    // Off the cycle: of the moves that keep the tail reachable, the one
+    // farthest from it
+    Direction best = snake.getDirection();
+    int bestRoute = -1;
+    bool anySafe = false;
+    for (Direction dir : ALL_DIRECTIONS) {
+        if (!isSafeMove(sim, dir)) continue;
+        if (!anySafe) {
+            // Something safe for now, even if nothing keeps the tail
+            anySafe = true;
+            best = dir;
+        }
+        int route = -1;
+        if (!outOfTime && keepsTail(dir, &route) && route > bestRoute) {
+            best = dir;
+            bestRoute = route;
+        }
+    }
+    return best;
+}
+
+Direction AutopilotBot::decide(const SnakeSim& sim) {
+    const int head = cellOf(sim.getSnake().getHead());
+    const int fruit = cellOf(sim.getFruit().getPosition());
+    // Keep walking the plan while the game is exactly where it expected
+    const bool onPlan = pathStep < path.size() && pathFruit == fruit && expectedHead == head &&
+                        expectedTick == sim.getTicks() && expectedSeed == sim.getSeed();
+    if (onPlan) {
+        ++stats.reused;
+    } else {
+        ++stats.searches;
+        const bool ordered = bodyFollowsCycle(sim.getSnake().getBody());
+        if (!planToFruit(sim, ordered)) {
+            reset();
+            ++stats.fallbacks;
+            if (outOfTime) ++stats.overBudget;
+            return fallback(sim, ordered);
+        }
+        pathFruit = fruit;
+    }
+    const int next = path[pathStep++];
+    expectedHead = next;
+    expectedTick = sim.getTicks() + 1;
+    expectedSeed = sim.getSeed();
+    return directionTo(head, next);
+}
+
+Direction AutopilotBot::choose(const SnakeSim& sim) {
+    const auto start = std::chrono::steady_clock::now();
+    deadline = start + budget;
+    outOfTime = false;
+    const Direction dir = decide(sim);
+    const std::uint64_t ns = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    ++stats.ticks;
+    stats.totalNs += ns;
+    stats.maxNs = std::max(stats.maxNs, ns);
+    return dir;
+}
+
+// AutopilotWorker Implementation
+AutopilotWorker::AutopilotWorker(int width, int height, std::chrono::nanoseconds budget)
+    : bot(width, height)
+    , inbox(width, height)
+    , working(width, height)
+    , thread([this] { run(); }) {
+    std::lock_guard<std::mutex> lock(mutex);
+    bot.setBudget(budget);
+}
+
+AutopilotWorker::~AutopilotWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void AutopilotWorker::request(const SnakeSim& sim) {
+    {
+        // Copy-assigning reuses the inbox's buffers, so this never allocates
+        std::lock_guard<std::mutex> lock(mutex);
+        inbox = sim;
+        hasRequest = true;
+    }
+    wake.notify_one();
+}
+
+bool AutopilotWorker::poll(const SnakeSim& sim, Direction& dir) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!hasResult || resultTick != sim.getTicks() || resultSeed != sim.getSeed()) return false;
+    hasResult = false;
+    dir = result;
+    return true;
+}
+
+AutopilotStats AutopilotWorker::getStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return published;
+}
+
+void AutopilotWorker::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this] { return stopping || hasRequest; });
+        if (stopping) return;
+        // Swapping hands over the buffers without copying under the lock
+        std::swap(working, inbox);
+        hasRequest = false;
+        lock.unlock();
+        const Direction dir = bot.choose(working);
+        lock.lock();
+        result = dir;
+        resultTick = working.getTicks();
+        resultSeed = working.getSeed();
+        hasResult = true;
+        published = bot.getStats();
+    }
+}
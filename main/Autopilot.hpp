@@ -0,0 +1,148 @@
+#pragma once
+
+// Self-playing snake for demo kiosks and soak tests.
+//
+// AutopilotBot plans a shortest path to the fruit with A*, but only takes it
+// if the tail is still reachable from where the snake would end up, so it
+// never walls itself in. When no such path exists it falls back to a
+// Hamiltonian cycle over the board.
+//
+// While the body lies in cycle order (it starts that way on boards with an
+// even height), A* is limited to cells ahead of the head and short of the
+// tail along the cycle. Such shortcuts keep the body in order, and from an
+// ordered body the next cycle cell is always safe, so the snake can fill the
+// board. Otherwise (player took over, odd-sized board) A* searches freely and
+// the fallback is the safe move that keeps the tail reachable and farthest
+// away, buying time for the body to clear.
+//
+// A plan is kept between ticks and only searched again when the fruit moves
+// or the snake leaves it.
+//
+// AutopilotWorker runs a bot on its own thread for the interactive game.
+
+#include "SnakeSim.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Next-step table of a Hamiltonian cycle over a width x height board,
+// indexed by y * width + x. Passes through the starting cells heading right
+// when the height is even. Empty when both sides are odd (no cycle exists).
+std::vector<Direction> hamiltonianCycle(int width, int height);
+
+struct AutopilotStats {
+    std::uint64_t ticks = 0;        // choose() calls
+    std::uint64_t searches = 0;     // fresh A* plans to the fruit
+    std::uint64_t reused = 0;       // steps taken from a kept plan
+    std::uint64_t fallbacks = 0;    // no safe path to the fruit this tick
+    std::uint64_t overBudget = 0;   // searches abandoned at the time budget
+    std::uint64_t totalNs = 0;      // time spent in choose()
+    std::uint64_t maxNs = 0;
+
+    void merge(const AutopilotStats& other);
+};
+
+class AutopilotBot {
+private:
+    struct OpenNode {
+        int f;
+        int g;
+        int cell;
+    };
+
+    int width;
+    int height;
+    std::vector<Direction> cycle;
+    std::vector<int> cycleIndex;        // position of each cell along the cycle
+
+    // Kept plan: cells from the next step to the fruit
+    std::vector<int> path;
+    size_t pathStep = 0;
+    int pathFruit = -1;
+    int expectedHead = -1;
+    std::uint64_t expectedTick = 0;
+    std::uint64_t expectedSeed = 0;
+
+    std::chrono::nanoseconds budget{0};
+    std::chrono::steady_clock::time_point deadline;
+    bool outOfTime = false;
+
+    // Search scratch, sized to the board once so planning never allocates.
+    // freeAt[c] is how many moves until cell c is vacated (0 = free now).
+    std::vector<int> freeAt;
+    std::vector<int> virtualFreeAt;
+    std::vector<int> parent;
+    std::vector<int> bestG;
+    std::vector<std::uint32_t> seen;    // == epoch when visited this search
+    std::uint32_t epoch = 0;
+    std::vector<OpenNode> open;
+    std::vector<int> virtualBody;
+    std::vector<int> scratchPath;
+
+    AutopilotStats stats;
+
+    int cellOf(const Position& p) const { return p.y * width + p.x; }
+    Direction directionTo(int from, int to) const;
+    // Steps from one cell to another going forward along the cycle
+    int cycleSpan(int from, int to) const;
+    bool bodyFollowsCycle(const SnakeBody& body) const;
+    // A* from start to goal where cell c can be entered on move g only once
+    // blocked[c] <= g. With arcEnd > 0 every step must also move forward
+    // along the cycle and stay less than arcEnd cycle steps from start.
+    // Writes the path (first step first) to out; returns its length or -1.
+    int findPath(int start, int goal, const std::vector<int>& blocked, std::vector<int>* out, int arcEnd = 0);
+    // Whether the tail is reachable after the head walks steps (first step
+    // first) from the current body, growing by one if it ends on the fruit.
+    bool tailReachable(const SnakeBody& body, const int* steps, size_t count, bool grows, int* routeLength);
+    bool planToFruit(const SnakeSim& sim, bool ordered);
+    Direction fallback(const SnakeSim& sim, bool ordered);
+    Direction decide(const SnakeSim& sim);
+
+public:
+    AutopilotBot(int width, int height);
+    // Time allowed for one choose(); zero (the default) is unlimited. A
+    // search still running at the deadline is abandoned and the fallback
+    // move is used for that tick.
+    void setBudget(std::chrono::nanoseconds perTick) { budget = perTick; }
+    // Forgets the kept plan, e.g. after SnakeSim::reset()
+    void reset();
+    Direction choose(const SnakeSim& sim);
+    const AutopilotStats& getStats() const { return stats; }
+    void resetStats() { stats = AutopilotStats(); }
+};
+
+// Runs an AutopilotBot on a background thread so the game loop never waits
+// on a search. After each tick the game hands over a copy of the simulation
+// with request(); before the next tick it collects the move with poll(). If
+// the move is not ready in time the caller plays its own fallback.
+class AutopilotWorker {
+private:
+    AutopilotBot bot;               // worker thread only
+    SnakeSim inbox;                 // latest request
+    SnakeSim working;               // worker thread's copy
+    bool hasRequest = false;
+    bool stopping = false;
+    bool hasResult = false;
+    std::uint64_t resultTick = 0;
+    std::uint64_t resultSeed = 0;
+    Direction result = Direction::RIGHT;
+    AutopilotStats published;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread thread;             // declared last: started once the rest exists
+    void run();
+
+public:
+    AutopilotWorker(int width, int height, std::chrono::nanoseconds budget);
+    ~AutopilotWorker();
+    AutopilotWorker(const AutopilotWorker&) = delete;
+    AutopilotWorker& operator=(const AutopilotWorker&) = delete;
+    // Replaces any request the worker has not started on
+    void request(const SnakeSim& sim);
+    // The move for the game state at sim's current tick, if it is ready
+    bool poll(const SnakeSim& sim, Direction& dir);
+    AutopilotStats getStats();
+};
@@ -0,0 +1,52 @@
+#include "Bots.hpp"
+#include <cstdlib>
+
+namespace {
+const Direction ALL_DIRECTIONS[4] = { Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT };
+}
+
+bool isSafeMove(const SnakeSim& sim, Direction dir) {
+    const Snake& snake = sim.getSnake();
+    if (isOpposite(dir, snake.getDirection())) {
+        return false;
+    }
+    Position next = snake.getHead() + directionVector(dir);
+    if (!sim.isValidPosition(next)) {
+        return false;
+    }
+    // The tail always moves out of the way this tick (growth only happens
+    // after the head lands on the fruit), so following it is safe.
+    return !snake.occupies(next) || next == snake.getBody().back();
+}
+
+Direction RandomBot::choose(const SnakeSim& sim) {
+    Direction options[4];
+    std::uint32_t count = 0;
+    for (Direction dir : ALL_DIRECTIONS) {
+        if (isSafeMove(sim, dir)) options[count++] = dir;
+    }
+    if (count == 0) return sim.getSnake().getDirection();
+    return options[rng.below(count)];
+}
+
+Direction GreedyBot::choose(const SnakeSim& sim) {
+    const Position head = sim.getSnake().getHead();
+    const Position fruit = sim.getFruit().getPosition();
+    Direction options[4];
+    std::uint32_t count = 0;
+    int bestDistance = 0;
+    for (Direction dir : ALL_DIRECTIONS) {
+        if (!isSafeMove(sim, dir)) continue;
+        Position next = head + directionVector(dir);
+        int distance = std::abs(next.x - fruit.x) + std::abs(next.y - fruit.y);
+        if (count == 0 || distance < bestDistance) {
+            bestDistance = distance;
+            count = 0;
+        } else if (distance > bestDistance) {
+            continue;
+        }
+        options[count++] = dir;
+    }
+    if (count == 0) return sim.getSnake().getDirection();
+    return options[count == 1 ? 0 : rng.below(count)];
+}
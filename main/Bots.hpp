@@ -0,0 +1,30 @@
+#pragma once
+
+// Simple scripted policies for headless runs. Each bot picks the direction
+// to pass to SnakeSim::step() for the next tick.
+
+#include "SnakeSim.hpp"
+
+// True if moving the head one cell in dir this tick is not immediately fatal.
+bool isSafeMove(const SnakeSim& sim, Direction dir);
+
+// Uniformly random choice among the safe, non-reversing directions.
+class RandomBot {
+private:
+    SimRng rng;
+
+public:
+    explicit RandomBot(std::uint64_t seed = 0) : rng(seed) {}
+    Direction choose(const SnakeSim& sim);
+};
+
+// Safe move that minimises Manhattan distance to the fruit; ties are broken
+// at random so games with different seeds diverge.
+class GreedyBot {
+private:
+    SimRng rng;
+
+public:
+    explicit GreedyBot(std::uint64_t seed = 0) : rng(seed) {}
+    Direction choose(const SnakeSim& sim);
+};
@@ -0,0 +1,119 @@
+#include "FrameEncoder.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+// FrameEncoder Implementation
+bool FrameEncoder::open(const std::string& outPath, unsigned frameWidth, unsigned frameHeight, std::size_t queueFrames) {
+    close();
+    path = outPath;
+    width = frameWidth;
+    height = frameHeight;
+    rawVideo = path.size() > 4 && path.compare(path.size() - 4, 4, ".rgb") == 0;
+    if (rawVideo) {
+        stream = std::fopen(path.c_str(), "wb");
+        if (!stream) return false;
+    } else {
+        std::error_code ec;
+        std::filesystem::create_directories(path, ec);
+        if (!std::filesystem::is_directory(path, ec)) return false;
+    }
+    // Every buffer is allocated here, none per frame
+    slots.assign(std::max<std::size_t>(queueFrames, 1), std::vector<std::uint8_t>(static_cast<std::size_t>(width) * height * 4));
+    row.resize(static_cast<std::size_t>(width) * 3);
+    submitted = 0;
+    written = 0;
+    closing = false;
+    stats = Stats();
+    worker = std::thread([this] { workerLoop(); });
+    return true;
+}
+
+void FrameEncoder::submit(const std::uint8_t* rgba) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!worker.joinable()) return;
+    if (submitted - written == slots.size()) {
+        const Clock::time_point start = Clock::now();
+        slotFree.wait(lock, [this] { return submitted - written < slots.size(); });
+        ++stats.blockedSubmits;
+        stats.blockedNs += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    }
+    std::vector<std::uint8_t>& slot = slots[submitted % slots.size()];
+    // The encoder never touches a slot between written and submitted
+    lock.unlock();
+    std::memcpy(slot.data(), rgba, slot.size());
+    lock.lock();
+    ++submitted;
+    frameReady.notify_one();
+}
+
+void FrameEncoder::close() {
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    frameReady.notify_one();
+    worker.join();
+    if (stream) {
+        if (std::fclose(stream) != 0) stats.failed = true;
+        stream = nullptr;
+    }
+}
+
+FrameEncoder::Stats FrameEncoder::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void FrameEncoder::workerLoop() {
+    for (;;) {
+        std::uint64_t index;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            frameReady.wait(lock, [this] { return closing || written < submitted; });
+            if (written == submitted) return;
+            index = written;
+        }
+        const Clock::time_point start = Clock::now();
+        const bool ok = !stats.failed && write(index, slots[index % slots.size()].data());
+        const std::uint64_t ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++written;
+            if (ok) {
+                ++stats.frames;
+                stats.bytes += static_cast<std::uint64_t>(width) * height * 3;
+                stats.encodeNs += ns;
+                stats.maxEncodeNs = std::max(stats.maxEncodeNs, ns);
+            } else {
+                stats.failed = true;
+            }
+        }
+        slotFree.notify_one();
+    }
+}
+
+// RGBA to RGB, a row at a time
+bool FrameEncoder::write(std::uint64_t index, const std::uint8_t* rgba) {
+    std::FILE* out = stream;
+    if (!rawVideo) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "frame-%06llu.ppm", static_cast<unsigned long long>(index));
+        out = std::fopen((std::filesystem::path(path) / name).string().c_str(), "wb");
+        if (!out) return false;
+        std::fprintf(out, "P6\n%u %u\n255\n", width, height);
+    }
+    bool ok = true;
+    for (unsigned y = 0; y < height && ok; ++y) {
+        const std::uint8_t* src = rgba + static_cast<std::size_t>(y) * width * 4;
+        for (unsigned x = 0; x < width; ++x) {
+            row[x * 3] = src[x * 4];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        ok = std::fwrite(row.data(), 1, row.size(), out) == row.size();
+    }
+    if (!rawVideo && std::fclose(out) != 0) ok = false;
+    return ok;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+// Writes captured frames on a background thread. Frames are copied into a
+// fixed ring of queueFrames buffers; when every buffer is still waiting to
+// be written, submit() blocks until the encoder frees one, so a slow disk
+// slows the producer down instead of growing memory or dropping frames.
+//
+// A path ending in ".rgb" gets one raw RGB24 stream (for example
+// ffmpeg -f rawvideo -pix_fmt rgb24 -s WxH -r FPS -i PATH out.mp4);
+// anything else is a directory of frame-000000.ppm, frame-000001.ppm, ...
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class FrameEncoder {
+public:
+    struct Stats {
+        std::uint64_t frames = 0;           // written
+        std::uint64_t bytes = 0;
+        std::uint64_t encodeNs = 0;         // encoder thread, converting and writing
+        std::uint64_t maxEncodeNs = 0;
+        std::uint64_t blockedSubmits = 0;   // submit() calls that waited for a free buffer
+        std::uint64_t blockedNs = 0;
+        bool failed = false;                // a write failed; later frames are dropped
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::string path;
+    bool rawVideo = false;
+    unsigned width = 0;
+    unsigned height = 0;
+    std::FILE* stream = nullptr;        // raw video only
+    std::vector<std::vector<std::uint8_t>> slots;   // RGBA frames
+    std::vector<std::uint8_t> row;      // RGB scratch, encoder thread only
+    std::uint64_t submitted = 0;        // frames handed over; slot = index % slots.size()
+    std::uint64_t written = 0;
+    bool closing = false;
+    Stats stats;
+    mutable std::mutex mutex;
+    std::condition_variable frameReady;
+    std::condition_variable slotFree;
+    std::thread worker;
+
+    void workerLoop();
+    bool write(std::uint64_t index, const std::uint8_t* rgba);
+
+public:
+    FrameEncoder() = default;
+    ~FrameEncoder() { close(); }
+    FrameEncoder(const FrameEncoder&) = delete;
+    FrameEncoder& operator=(const FrameEncoder&) = delete;
+
+    bool open(const std::string& path, unsigned width, unsigned height, std::size_t queueFrames);
+    // Queues a width x height RGBA frame, blocking while the queue is full
+    void submit(const std::uint8_t* rgba);
+    // Writes whatever is queued and stops the thread
+    void close();
+    Stats getStats() const;
+    const std::string& getPath() const { return path; }
+};
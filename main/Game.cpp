@@ -1,155 +1,137 @@
 #include "Game.hpp"
+#include "Bots.hpp"
 #include <iostream>
-#include <sstream>
 #include <algorithm>
+#include <charconv>
 #include <cmath>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
 
-// Snake Implementation
-Snake::Snake() : direction(Direction::RIGHT), nextDirection(Direction::RIGHT) {
-    reset();
-}
+#if !defined(_WIN32)
+#include <time.h>
+#endif
 
-void Snake::reset() {
-    body.clear();
-    body.push_back(Position(20, 15)); // Center of grid
-    body.push_back(Position(19, 15));
-    body.push_back(Position(18, 15));
-    direction = Direction::RIGHT;
-    nextDirection = Direction::RIGHT;
-}
+// AudioManager Implementation
+AudioManager::AudioManager() : soundEnabled(true), musicEnabled(true) {}
 
-void Snake::move() {
-    direction = nextDirection;
-    
-    Position directionVector;
-    switch (direction) {
-        case Direction::UP:    directionVector = Position(0, -1); break;
-        case Direction::DOWN:  directionVector = Position(0, 1); break;
-        case Direction::LEFT:  directionVector = Position(-1, 0); break;
-        case Direction::RIGHT: directionVector = Position(1, 0); break;
-    }
-    
-    Position newHead = body.front() + directionVector;
-    body.insert(body.begin(), newHead);
-    body.pop_back();
-}
+std::unique_ptr<sf::SoundBuffer> AudioManager::loadEffect(const AssetBundle& bundle, Effect effect) {
+    static const char* const packedNames[EFFECT_COUNT] = { assets::EAT_SOUND, assets::GAME_OVER_SOUND, assets::MOVE_SOUND };
+    static const char* const fileNames[EFFECT_COUNT] = { "eat", "gameover", "move" };
+    auto buffer = std::make_unique<sf::SoundBuffer>();
 
-void Snake::grow() {
-    // Don't remove the tail on next move
-    Position directionVector;
-    switch (direction) {
-        case Direction::UP:    directionVector = Position(0, -1); break;
-        case Direction::DOWN:  directionVector = Position(0, 1); break;
-        case Direction::LEFT:  directionVector = Position(-1, 0); break;
-        case Direction::RIGHT: directionVector = Position(1, 0); break;
+    // Pre-decoded PCM from the bundle skips the decoder entirely
+    if (const AssetBundle::Entry* e = bundle.find(packedNames[effect], AssetBundle::SAMPLES)) {
+        const std::vector<sf::SoundChannel> channels = e->meta[0] == 1
+            ? std::vector<sf::SoundChannel>{ sf::SoundChannel::Mono }
+            : std::vector<sf::SoundChannel>{ sf::SoundChannel::FrontLeft, sf::SoundChannel::FrontRight };
+        if (buffer->loadFromSamples(reinterpret_cast<const std::int16_t*>(e->data), e->size / sizeof(std::int16_t),
+                                    e->meta[0], e->meta[1], channels)) {
+            return buffer;
+        }
     }
-    
-    Position newHead = body.front() + directionVector;
-    body.insert(body.begin(), newHead);
+    const std::string base = std::string("assets/audios/") + fileNames[effect];
+    for (const char* ext : { ".wav", ".ogg", ".mp3" }) {
+        if (buffer->loadFromFile(base + ext)) return buffer;
+    }
+    return nullptr;
 }
 
-void Snake::setDirection(Direction dir) {
-    // Prevent 180-degree turns
-    bool canChangeDirection = false;
-    switch (dir) {
-        case Direction::UP:    canChangeDirection = (direction != Direction::DOWN); break;
-        case Direction::DOWN:  canChangeDirection = (direction != Direction::UP); break;
-        case Direction::LEFT:  canChangeDirection = (direction != Direction::RIGHT); break;
-        case Direction::RIGHT: canChangeDirection = (direction != Direction::LEFT); break;
-    }
-    
-    if (canChangeDirection) {
-        nextDirection = dir;
+std::unique_ptr<sf::Music> AudioManager::openMusic(const AssetBundle& bundle) {
+    auto stream = std::make_unique<sf::Music>();
+    const AssetBundle::Entry* packed = bundle.find(assets::MUSIC, AssetBundle::RAW);
+    if ((packed && stream->openFromMemory(packed->data, packed->size)) ||
+        stream->openFromFile("assets/audios/bgmusic.ogg") || stream->openFromFile("assets/audios/bgmusic.mp3") ||
+        stream->openFromFile("assets/audios/bgmusic.wav")) {
+        return stream;
     }
+    return nullptr;
 }
 
-bool Snake::checkSelfCollision() const {
-    const Position& head = body.front();
-    for (size_t i = 1; i < body.size(); ++i) {
-        if (head == body[i]) {
-            return true;
+void AudioManager::setEffect(Effect effect, std::unique_ptr<sf::SoundBuffer> buffer) {
+    if (!buffer) {
+        // The move sound is optional; without eat or game-over sounds, effects are off
+        if (effect != MOVE) {
+            std::cerr << "Warning: " << (effect == EAT ? "eat" : "gameover") << " sound not found in assets/audios/" << std::endl;
+            soundEnabled = false;
         }
+        return;
+    }
+    // Voices still bound to a buffer being replaced are released first
+    for (Voice& voice : voices) {
+        if (voice.effect == effect) {
+            voice.sound->stop();
+            voice.effect = EFFECT_COUNT;
+        }
+    }
+    buffers[effect] = std::move(buffer);
+    if (!voices[0].sound) {
+        // sf::Sound needs a buffer to exist; rebinding later is cheap
+        for (Voice& voice : voices) voice.sound = std::make_unique<sf::Sound>(*buffers[effect]);
     }
-    return false;
-}
-
-// Fruit Implementation
-Fruit::Fruit(int gridWidth, int gridHeight) 
-    : rng(std::random_device{}())
-    , xDist(0, gridWidth - 1)
-    , yDist(0, gridHeight - 1) {
-    position = Position(xDist(rng), yDist(rng));
 }
 
-void Fruit::respawn(const std::vector<Position>& snakeBody) {
-    do {
-        position = Position(xDist(rng), yDist(rng));
-    } while (std::find(snakeBody.begin(), snakeBody.end(), position) != snakeBody.end());
+void AudioManager::setMusic(std::unique_ptr<sf::Music> stream) {
+    if (!stream) {
+        std::cerr << "Info: background music not found in assets/audios/" << std::endl;
+        musicEnabled = false;
+        return;
+    }
+    music = std::move(stream);
+    startMusic();
 }
 
-// AudioManager Implementation
-AudioManager::AudioManager() : eatSound(), gameOverSound(), moveSound(), music(), soundEnabled(true), musicEnabled(true) {}
+void AudioManager::play(Effect effect) {
+    if (!soundEnabled || !buffers[effect]) return;
 
-bool AudioManager::loadSounds() {
-    bool success = true;
-    auto tryLoadSound = [&](sf::SoundBuffer& buf, const std::vector<std::string>& names) -> bool {
-        for (const auto& n : names) {
-            if (buf.loadFromFile(n)) return true;
+    Voice* idle = nullptr;
+    Voice* oldest = nullptr;
+    Voice* oldestOwn = nullptr;
+    int own = 0;
+    for (Voice& voice : voices) {
+        if (voice.effect == EFFECT_COUNT || voice.sound->getStatus() != sf::SoundSource::Status::Playing) {
+            if (!idle) idle = &voice;
+            continue;
         }
-        return false;
-    };
-
-    // Base directory for our known assets
-    const std::string base = "assets/audios/";
-    if (tryLoadSound(eatBuffer, { base + "eat.wav", base + "eat.ogg", base + "eat.mp3" })) {
-        eatSound = std::make_unique<sf::Sound>(eatBuffer);
-    } else { std::cerr << "Warning: eat sound not found in " << base << std::endl; success = false; }
-
-    if (tryLoadSound(gameOverBuffer, { base + "gameover.wav", base + "gameover.ogg", base + "gameover.mp3" })) {
-        gameOverSound = std::make_unique<sf::Sound>(gameOverBuffer);
-    } else { std::cerr << "Warning: gameover sound not found in " << base << std::endl; success = false; }
-
-    if (tryLoadSound(moveBuffer, { base + "move.wav", base + "move.ogg", base + "move.mp3" })) {
-        moveSound = std::make_unique<sf::Sound>(moveBuffer);
-    } // optional, no warning
-
-    music = std::make_unique<sf::Music>();
-    if (musicEnabled) {
-        if (!(music->openFromFile(base + "bgmusic.ogg") || music->openFromFile(base + "bgmusic.mp3") || music->openFromFile(base + "bgmusic.wav"))) {
-            std::cerr << "Info: background music not found in " << base << std::endl;
-            musicEnabled = false;
-        } else {
-#ifdef SFML_AUDIO_VERSION_3
-            music->setLooping(true);
-#endif
-            music->setVolume(MUSIC_VOLUME);
-            music->play();
+        if (!oldest || voice.started < oldest->started) oldest = &voice;
+        if (voice.effect == effect) {
+            ++own;
+            if (!oldestOwn || voice.started < oldestOwn->started) oldestOwn = &voice;
         }
     }
-    if (!success) soundEnabled = false;
-    return success;
+    // At its cap an effect restarts its own oldest voice; otherwise it takes
+    // an idle voice, or steals the oldest one when all are busy
+    Voice* voice = own >= MAX_VOICES[effect] ? oldestOwn : idle ? idle : oldest;
+
+    voice->sound->stop();
+    if (voice->effect != effect) {
+        voice->sound->setBuffer(*buffers[effect]);
+        voice->effect = effect;
+    }
+    voice->started = ++triggers;
+#ifdef SNAKE_PROFILE
+    voice->triggeredNs = profiler::nowNs();
+#endif
+    voice->sound->play();
 }
 
 void AudioManager::playEatSound() {
-    if (soundEnabled && eatSound) {
-        eatSound->play();
-    }
+    PROFILE_SCOPE("audio.eat");
+    play(EAT);
 }
 
 void AudioManager::playGameOverSound() {
-    if (soundEnabled && gameOverSound) {
-        gameOverSound->play();
-    }
+    PROFILE_SCOPE("audio.gameOver");
+    play(GAME_OVER);
 }
 
 void AudioManager::playMoveSound() {
-    if (soundEnabled && moveSound) {
-        if (moveSound->getStatus() != sf::SoundSource::Status::Playing) {
-            moveSound->play();
-        }
-    }
+    PROFILE_SCOPE("audio.move");
+    play(MOVE);
 }
 
 void AudioManager::startMusic() {
@@ -171,102 +153,503 @@ void AudioManager::toggleMusic() {
     if (musicEnabled) startMusic(); else stopMusic();
 }
 
+#ifdef SNAKE_PROFILE
+void AudioManager::pollLatency() {
+    const std::uint64_t now = profiler::nowNs();
+    for (Voice& voice : voices) {
+        if (!voice.triggeredNs || voice.effect == EFFECT_COUNT) continue;
+        // The offset is how much the mixer has already consumed, so
+        // subtracting it gives the start time independent of when we poll
+        const std::int64_t offsetUs = voice.sound->getPlayingOffset().asMicroseconds();
+        if (offsetUs <= 0) {
+            if (voice.sound->getStatus() != sf::SoundSource::Status::Playing) voice.triggeredNs = 0;
+            continue;
+        }
+        const double startedMs = (now - voice.triggeredNs) / 1e6 - offsetUs / 1e3;
+        latencyMs[latencyCount++ % LATENCY_HISTORY] = static_cast<float>(std::max(0.0, startedMs));
+        voice.triggeredNs = 0;
+    }
+}
+
+AudioManager::LatencyStats AudioManager::latencyStats() const {
+    LatencyStats stats{0.f, 0.f, std::min(latencyCount, LATENCY_HISTORY), 0};
+    for (const Voice& voice : voices) {
+        if (voice.effect != EFFECT_COUNT && voice.sound->getStatus() == sf::SoundSource::Status::Playing) {
+            ++stats.busyVoices;
+        }
+    }
+    if (stats.samples == 0) return stats;
+    float sorted[LATENCY_HISTORY];
+    std::copy(latencyMs, latencyMs + stats.samples, sorted);
+    std::sort(sorted, sorted + stats.samples);
+    stats.p50Ms = sorted[stats.samples / 2];
+    stats.maxMs = sorted[stats.samples - 1];
+    return stats;
+}
+#endif
+
+// Hud Implementation
+void Hud::add(Label label, const sf::Font& font, const char* content, unsigned size, sf::Color color,
+              sf::Vector2f anchor, bool centered) {
+    Widget& widget = widgets[label];
+    widget.text = std::make_unique<sf::Text>(font, content, size);
+    widget.text->setFillColor(color);
+    widget.content = content;
+    widget.anchor = anchor;
+    widget.centered = centered;
+    layout(widget);
+}
+
+void Hud::create(const sf::Font& font, const sf::View& hudView) {
+    view = hudView;
+    const sf::Vector2f center = view.getCenter();
+    add(SCORE, font, "Score: 0 | Speed: 0", 24, sf::Color::White, {10.f, 10.f}, false);
+    add(MENU, font, "Press SPACE to Start\nArrow Keys to Move\nA for Autopilot\nP to Pause\nS to Toggle Sound\nESC to Quit", 24,
+        sf::Color::White, center, true);
+    add(PAUSED, font, "PAUSED", 48, sf::Color::Yellow, center, true);
+    add(GAME_OVER, font, "GAME OVER", 48, sf::Color::Red, {center.x, center.y - 50.f}, true);
+    add(WIN, font, "YOU WIN", 48, sf::Color::Green, {center.x, center.y - 50.f}, true);
+    add(RESTART, font, "Press SPACE to Restart", 24, sf::Color::White, {center.x, center.y + 50.f}, true);
+    add(LOADING, font, "Loading assets", 16, sf::Color(200, 200, 200), {10.f, view.getSize().y - 26.f}, false);
+    dirty = true;
+}
+
+void Hud::layout(Widget& widget) {
+    if (widget.centered) {
+        sf::FloatRect bounds = widget.text->getLocalBounds();
+        widget.text->setOrigin({bounds.position.x + bounds.size.x / 2.0f, bounds.position.y + bounds.size.y / 2.0f});
+    }
+    widget.text->setPosition(widget.anchor);
+    if (widget.visible) dirty = true;
+}
+
+void Hud::resize(sf::Vector2u pixelSize) {
+    layerSprite.reset();
+    if (!layer.resize(pixelSize)) {
+        std::cerr << "Warning: Could not create HUD layer; drawing text directly." << std::endl;
+        return;
+    }
+    // Rendered at the window's pixel size through the HUD view, then scaled
+    // back to view units on the blit, as for the background layer
+    layerSprite = std::make_unique<sf::Sprite>(layer.getTexture());
+    layerSprite->setScale({view.getSize().x / pixelSize.x, view.getSize().y / pixelSize.y});
+    layerSprite->setPosition(view.getCenter() - view.getSize() / 2.f);
+    dirty = true;
+}
+
+void Hud::setFont(const sf::Font& font) {
+    for (Widget& widget : widgets) {
+        if (!widget.text) continue;
+        widget.text->setFont(font);
+        layout(widget);
+    }
+    dirty = true;
+}
+
+void Hud::setString(Label label, const char* content) {
+    Widget& widget = widgets[label];
+    if (!widget.text || widget.content == content) return;
+    widget.content = content;   // reuses the string's capacity
+    widget.text->setString(content);
+    layout(widget);
+}
+
+void Hud::setVisible(Label label, bool visible) {
+    Widget& widget = widgets[label];
+    if (widget.visible == visible) return;
+    widget.visible = visible;
+    dirty = true;
+}
+
+void Hud::draw(sf::RenderTarget& target) {
+    if (!layerSprite) {
+        for (const Widget& widget : widgets) {
+            if (widget.visible && widget.text) target.draw(*widget.text);
+        }
+        return;
+    }
+    if (dirty) {
+        layer.setView(view);
+        layer.clear(sf::Color::Transparent);
+        for (const Widget& widget : widgets) {
+            if (widget.visible && widget.text) layer.draw(*widget.text);
+        }
+        layer.display();
+        dirty = false;
+    }
+    // Text blended onto a transparent layer leaves premultiplied colour, so
+    // composite it with (One, OneMinusSrcAlpha) to keep edges from darkening
+    static const sf::BlendMode premultiplied(sf::BlendMode::Factor::One, sf::BlendMode::Factor::OneMinusSrcAlpha);
+    target.draw(*layerSprite, sf::RenderStates(premultiplied));
+}
+
 // Game Implementation
-Game::Game() 
+bool Game::isValidBoardSize(int width, int height) {
+    return width >= MIN_BOARD_SIDE && width <= MAX_BOARD_SIDE &&
+           height >= MIN_BOARD_SIDE && height <= MAX_BOARD_SIDE;
+}
+
+Game::Game(int gridWidth, int gridHeight) 
     : window(sf::VideoMode({WINDOW_WIDTH, WINDOW_HEIGHT}), "Modern Snake Game", sf::Style::Titlebar | sf::Style::Close)
-    , fruit(GRID_WIDTH, GRID_HEIGHT)
+    , sim(gridWidth, gridHeight, std::random_device{}())
     , gameState(GameState::MENU)
-    , score(0)
-    , gameSpeed(BASE_SPEED)
-    , lastUpdate(sf::Time::Zero) {
+    , tickAccumulator(sf::Time::Zero)
+    , gridWidth(gridWidth)
+    , gridHeight(gridHeight) {
+    uiView = window.getDefaultView();
+    boardView = uiView;
 }
 
 bool Game::initialize() {
-    window.setFramerateLimit(60);
+    // Present at the display's refresh rate; interpolation keeps motion
+    // smooth above the tick rate. The cap only matters if vsync is forced off.
+    // A capture instead runs at its own frame rate.
+    window.setVerticalSyncEnabled(!encoder);
+    window.setFramerateLimit(encoder ? captureFps : MAX_FRAME_RATE);
     window.setKeyRepeatEnabled(false);
     
-    // Discover TTF fonts in assets/ttf
+    // Prefer the packed bundle (make bundle): one mapped file, no
+    // directory scans or decoding. Loose files in assets/ still work.
+    if (!bundle.open(assets::BUNDLE_PATH)) {
+        std::cout << "Info: no " << assets::BUNDLE_PATH << "; loading loose files from "
+                  << assets::ASSET_DIR << "/" << std::endl;
+    }
+
+    // Fonts: bundle entries by name, else discover TTF files in assets/ttf
     fontPaths.clear();
-    try {
-        for (const auto& entry : std::filesystem::directory_iterator("assets/ttf")) {
-            if (entry.is_regular_file()) {
-                auto p = entry.path();
-                if (p.extension() == ".ttf") fontPaths.push_back(p.string());
+    if (bundle.isOpen()) {
+        for (const AssetBundle::Entry& entry : bundle.entries()) {
+            if (entry.kind == AssetBundle::RAW && entry.name.rfind(assets::FONT_PREFIX, 0) == 0) {
+                fontPaths.push_back(entry.name);
             }
         }
-    } catch (...) {}
+    } else {
+        try {
+            for (const auto& entry : std::filesystem::directory_iterator("assets/ttf")) {
+                if (entry.is_regular_file()) {
+                    auto p = entry.path();
+                    if (p.extension() == ".ttf") fontPaths.push_back(p.string());
+                }
+            }
+        } catch (...) {}
+    }
     if (fontPaths.empty()) {
         fontPaths.push_back("assets/DejaVuSans.ttf"); // fallback candidate
     }
-    if (!font.openFromFile(fontPaths[0])) {
-        std::cerr << "Warning: Failed to load initial font: " << fontPaths[0] << std::endl;
-    }
-    
-    // Initialize text objects (construct after font load for SFML 3)
-    scoreText = std::make_unique<sf::Text>(font, "Score: 0 | Speed: 0", 24);
-    scoreText->setFillColor(sf::Color::White);
-    scoreText->setPosition({10, 10});
-
-    gameOverText = std::make_unique<sf::Text>(font, "GAME OVER", 48);
-    gameOverText->setFillColor(sf::Color::Red);
-    sf::FloatRect textRect = gameOverText->getLocalBounds();
-    gameOverText->setOrigin({textRect.position.x + textRect.size.x / 2.0f, textRect.position.y + textRect.size.y / 2.0f});
-    gameOverText->setPosition({WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f - 50});
-    
-    menuText = std::make_unique<sf::Text>(font, "Press SPACE to Start\nArrow Keys to Move\nP to Pause\nS to Toggle Sound\nESC to Quit", 24);
-    menuText->setFillColor(sf::Color::White);
-    textRect = menuText->getLocalBounds();
-    menuText->setOrigin({textRect.position.x + textRect.size.x / 2.0f, textRect.position.y + textRect.size.y / 2.0f});
-    menuText->setPosition({WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f});
-    
-    pauseText = std::make_unique<sf::Text>(font, "PAUSED", 48);
-    pauseText->setFillColor(sf::Color::Yellow);
-    textRect = pauseText->getLocalBounds();
-    pauseText->setOrigin({textRect.position.x + textRect.size.x / 2.0f, textRect.position.y + textRect.size.y / 2.0f});
-    pauseText->setPosition({WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f});
+    fontCache.clear();
+    fontCache.resize(fontPaths.size());
+    currentFontIndex = 0;
+    selectedFont = 0;
+    windowSize = layerSize = window.getSize();
     
-    // Load textures
-    texturesLoaded = bgTexture.loadFromFile("assets/imgs/bg.png") &&
-                     headTexture.loadFromFile("assets/imgs/head.png") &&
-                     bodyTexture.loadFromFile("assets/imgs/body.png");
-    fruitTextureLoaded = fruitTexture.loadFromFile("assets/imgs/fruit.png");
-    if (texturesLoaded) {
-        backgroundSprite = std::make_unique<sf::Sprite>(bgTexture);
-        // Scale background to cover window (maintain aspect ratio, center)
-        auto texSize = bgTexture.getSize();
-        float scaleX = (float)WINDOW_WIDTH / texSize.x;
-        float scaleY = (float)WINDOW_HEIGHT / texSize.y;
-        float scale = std::max(scaleX, scaleY); // cover
-        backgroundSprite->setScale(sf::Vector2f(scale, scale));
-        // center
-        float drawnW = texSize.x * scale;
-        float drawnH = texSize.y * scale;
-        backgroundSprite->setPosition(sf::Vector2f((WINDOW_WIDTH - drawnW) / 2.f, (WINDOW_HEIGHT - drawnH) / 2.f));
-    } else {
-        std::cerr << "Warning: Could not load one or more textures." << std::endl;
+    // Only the first font and the procedural atlas tiles are loaded up
+    // front, so the menu can show immediately; everything else streams in
+    // from loadAssetsAsync() and falls back to the untextured look until then.
+    hud.create(loadFont(currentFontIndex), uiView);
+    hud.resize(layerSize);
+    updateScore();
+    buildAtlas();
+    rebuildBackgroundLayer();
+    loadAssetsAsync();
+
+    return true;
+}
+
+void Game::loadAssetsAsync() {
+    // Sprites: decode and pre-scale on the worker, upload into the atlas here
+    struct SpriteJob { const char* name; const char* path; AtlasTile tile; };
+    const SpriteJob sprites[] = {
+        { assets::HEAD_IMAGE, "assets/imgs/head.png", TILE_HEAD },
+        { assets::BODY_IMAGE, "assets/imgs/body.png", TILE_BODY },
+        { assets::FRUIT_IMAGE, "assets/imgs/fruit.png", TILE_FRUIT },
+    };
+    for (const SpriteJob& job : sprites) {
+        ++assetsTotal;
+        loaderPool.submit([this, job] {
+            auto image = std::make_shared<sf::Image>();
+            bool ok = loadImage(job.name, job.path, *image);
+            const sf::Vector2u tileSize(ATLAS_TILE, ATLAS_TILE);
+            if (ok && image->getSize() != tileSize) *image = assets::scaleImage(*image, tileSize);
+            postLoaded([this, job, image, ok] {
+                if (!ok) {
+                    std::cerr << "Warning: Could not load texture: " << job.path << std::endl;
+                    return;
+                }
+                atlasTexture.update(*image, tileOrigin(job.tile));
+                tileLoaded[job.tile] = true;
+                texturesLoaded = backgroundLoaded && tileLoaded[TILE_HEAD] && tileLoaded[TILE_BODY];
+                fruitTextureLoaded = tileLoaded[TILE_FRUIT];
+            });
+        });
+    }
+
+    ++assetsTotal;
+    loaderPool.submit([this] {
+        auto image = std::make_shared<sf::Image>();
+        bool ok = loadImage(assets::BACKGROUND_IMAGE, "assets/imgs/bg.png", *image);
+        postLoaded([this, image, ok] {
+            if (!ok || !bgTexture.loadFromImage(*image)) {
+                std::cerr << "Warning: Could not load texture: assets/imgs/bg.png" << std::endl;
+                return;
+            }
+            backgroundLoaded = true;
+            texturesLoaded = backgroundLoaded && tileLoaded[TILE_HEAD] && tileLoaded[TILE_BODY];
+            applyBackground();
+        });
+    });
+
+    for (int e = 0; e < AudioManager::EFFECT_COUNT; ++e) {
+        const auto effect = static_cast<AudioManager::Effect>(e);
+        ++assetsTotal;
+        loaderPool.submit([this, effect] {
+            auto buffer = std::make_shared<std::unique_ptr<sf::SoundBuffer>>(AudioManager::loadEffect(bundle, effect));
+            postLoadedAudio([this, effect, buffer] {
+                audioManager.setEffect(effect, std::move(*buffer));
+                updateScore();
+            });
+        });
+    }
+
+    ++assetsTotal;
+    loaderPool.submit([this] {
+        auto stream = std::make_shared<std::unique_ptr<sf::Music>>(AudioManager::openMusic(bundle));
+        postLoadedAudio([this, stream] {
+            audioManager.setMusic(std::move(*stream));
+            updateScore();
+        });
+    });
+
+    // The remaining fonts, so F cycles through memory only
+    for (size_t i = 1; i < fontPaths.size(); ++i) {
+        ++assetsTotal;
+        loaderPool.submit([this, i] {
+            std::shared_ptr<LoadedFont> font = openFont(fontPaths[i]);
+            postLoaded([this, i, font] {
+                if (!fontCache[i]) fontCache[i] = font;  // F may have loaded it already
+            });
+        });
+    }
+
+    assetsPending.store(assetsTotal);
+    updateLoadingText(assetsTotal);
+}
+
+void Game::postLoaded(std::function<void()> apply) {
+    {
+        std::lock_guard<std::mutex> lock(loadedMutex);
+        loadedAssets.push_back(std::move(apply));
+    }
+    wakeRenderer();
+}
+
+void Game::postLoadedAudio(std::function<void()> apply) {
+    std::lock_guard<std::mutex> lock(loadedMutex);
+    loadedAudio.push_back(std::move(apply));
+}
+
+// Render thread: textures and fonts
+void Game::pollLoadedAssets() {
+    applyLoaded(loadedAssets);
+}
+
+// Main thread: sounds and music
+void Game::pollLoadedAudio() {
+    applyLoaded(loadedAudio);
+}
+
+void Game::applyLoaded(std::vector<std::function<void()>>& queue) {
+    if (assetsPending.load(std::memory_order_relaxed) == 0) return;
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(loadedMutex);
+        ready.swap(queue);
     }
-    if (!fruitTextureLoaded) {
-        std::cerr << "Warning: Could not load fruit texture." << std::endl;
+    if (ready.empty()) return;
+    for (auto& apply : ready) {
+        apply();
+        if (assetsPending.fetch_sub(1) == 1) {
+            std::cout << "Assets: " << assetsTotal << " loaded after " << startupClock.getElapsedTime().asMilliseconds()
+                      << " ms" << std::endl;
+        }
     }
+    // The loading line changed
+    wakeRenderer();
+}
+
+void Game::finishLoadingAssets() {
+    loaderPool.wait();
+    pollLoadedAssets();
+    pollLoadedAudio();
+}
+
+void Game::applyBackground() {
+    backgroundSprite = std::make_unique<sf::Sprite>(bgTexture);
+    // Scale background to cover window (maintain aspect ratio, center)
+    auto texSize = bgTexture.getSize();
+    float scaleX = (float)WINDOW_WIDTH / texSize.x;
+    float scaleY = (float)WINDOW_HEIGHT / texSize.y;
+    float scale = std::max(scaleX, scaleY); // cover
+    backgroundSprite->setScale(sf::Vector2f(scale, scale));
+    // center
+    float drawnW = texSize.x * scale;
+    float drawnH = texSize.y * scale;
+    backgroundSprite->setPosition(sf::Vector2f((WINDOW_WIDTH - drawnW) / 2.f, (WINDOW_HEIGHT - drawnH) / 2.f));
+    rebuildBackgroundLayer();
+}
+
+sf::Vector2u Game::tileOrigin(AtlasTile tile) {
+    return sf::Vector2u(static_cast<unsigned>(tile * ATLAS_STRIDE + 1), 1u);
+}
 
-    // Load audio
-    audioManager.loadSounds();
-    // Set initial score text
-    // score text already set
+// Creates the atlas with only its procedural tiles; sprite tiles are
+// uploaded into it as loadAssetsAsync() delivers them.
+bool Game::buildAtlas() {
+    sf::Image atlas({ATLAS_STRIDE * TILE_COUNT, ATLAS_STRIDE}, sf::Color::Transparent);
 
+    // Procedural tiles for the untextured fallbacks and grid lines
+    const float radius = ATLAS_TILE / 2.f;
+    for (unsigned y = 0; y < ATLAS_TILE; ++y) {
+        for (unsigned x = 0; x < ATLAS_TILE; ++x) {
+            float dx = x + 0.5f - radius;
+            float dy = y + 0.5f - radius;
+            float coverage = std::clamp(radius - std::sqrt(dx * dx + dy * dy) + 0.5f, 0.f, 1.f);
+            sf::Vector2u circle = tileOrigin(TILE_CIRCLE);
+            atlas.setPixel({circle.x + x, circle.y + y}, sf::Color(255, 255, 255, static_cast<std::uint8_t>(coverage * 255)));
+            sf::Vector2u white = tileOrigin(TILE_WHITE);
+            atlas.setPixel({white.x + x, white.y + y}, sf::Color::White);
+        }
+    }
+    if (!atlasTexture.loadFromImage(atlas)) {
+        std::cerr << "Warning: Could not create sprite atlas." << std::endl;
+        return false;
+    }
+    atlasTexture.setSmooth(true);
+
+    // Grid lines + one quad per cell for the snake + fruit over the largest
+    // visible chunk range, so the buffer never grows after this.
+    const size_t spanX = WINDOW_WIDTH / CELL_SIZE + 2 * CHUNK_CELLS + 2;
+    const size_t spanY = WINDOW_HEIGHT / CELL_SIZE + 2 * CHUNK_CELLS + 2;
+    size_t maxQuads = (spanX + 1) + (spanY + 1) + spanX * spanY + 2;
+    boardVertices.reserve(maxQuads * 6);
     return true;
 }
 
-void Game::applyFont() {
-    if (fontPaths.empty()) return;
-    if (!font.openFromFile(fontPaths[currentFontIndex])) {
-        std::cerr << "Warning: Could not load font: " << fontPaths[currentFontIndex] << std::endl;
+bool Game::loadImage(const char* bundleName, const std::string& path, sf::Image& image) const {
+    const AssetBundle::Entry* packed = bundle.find(bundleName, AssetBundle::IMAGE);
+    if (packed && packed->size == static_cast<std::uint64_t>(packed->meta[0]) * packed->meta[1] * 4) {
+        image.resize({packed->meta[0], packed->meta[1]}, packed->data);
+        return true;
+    }
+    return image.loadFromFile(path);
+}
+
+void Game::appendQuad(sf::Vector2f center, sf::Vector2f size, int quarterTurns, AtlasTile tile, sf::Color color) {
+    const float u0 = static_cast<float>(tile * ATLAS_STRIDE + 1);
+    const float v0 = 1.f;
+    sf::Vector2f tex[4] = { {u0, v0}, {u0 + ATLAS_TILE, v0}, {u0 + ATLAS_TILE, v0 + ATLAS_TILE}, {u0, v0 + ATLAS_TILE} };
+    if (tile == TILE_WHITE) {
+        for (auto& t : tex) t = {u0 + ATLAS_TILE / 2.f, v0 + ATLAS_TILE / 2.f};
+    }
+    sf::Vector2f corner[4] = { {-size.x / 2.f, -size.y / 2.f}, {size.x / 2.f, -size.y / 2.f},
+                               {size.x / 2.f, size.y / 2.f}, {-size.x / 2.f, size.y / 2.f} };
+    // Clockwise quarter turns in screen space (y down): (x, y) -> (-y, x)
+    for (auto& c : corner) {
+        for (int i = 0; i < (quarterTurns & 3); ++i) c = {-c.y, c.x};
+        c += center;
+    }
+    const int order[6] = { 0, 1, 2, 0, 2, 3 };
+    for (int i : order) {
+        boardVertices.push_back(sf::Vertex{corner[i], color, tex[i]});
+    }
+}
+
+void Game::flushBoard(sf::RenderTarget& target) {
+    PROFILE_SCOPE("flushBoard");
+    if (!boardVertices.empty()) {
+        sf::RenderStates states(&atlasTexture);
+        target.draw(boardVertices.data(), boardVertices.size(), sf::PrimitiveType::Triangles, states);
+    }
+    boardVertices.clear(); // keeps capacity
+}
+
+void Game::rebuildBackgroundLayer() {
+    PROFILE_SCOPE("rebuildBackgroundLayer");
+    backgroundLayerSprite.reset();
+    if (!backgroundLayer.resize(layerSize)) {
+        std::cerr << "Warning: Could not create background layer; drawing it per frame." << std::endl;
         return;
     }
-    if (scoreText) scoreText->setFont(font);
-    if (gameOverText) gameOverText->setFont(font);
-    if (menuText) menuText->setFont(font);
-    if (pauseText) pauseText->setFont(font);
+    // Render at the window's pixel size through the game's logical view so
+    // the layer stays sharp, then scale the blit back to view units.
+    const sf::View& view = uiView;
+    backgroundLayer.setView(view);
+    backgroundLayer.clear(sf::Color::Black);
+    if (texturesLoaded && backgroundSprite) {
+        backgroundLayer.draw(*backgroundSprite);
+    }
+    // The camera never moves when the whole board fits, so the grid can be
+    // baked in; otherwise drawBoard() emits it per visible chunk.
+    if (boardFitsView()) {
+        aimCamera(cameraCenter({}));
+        backgroundLayer.setView(boardView);
+        drawGrid();
+        flushBoard(backgroundLayer);
+    }
+    backgroundLayer.display();
+    backgroundLayerSprite = std::make_unique<sf::Sprite>(backgroundLayer.getTexture());
+    sf::Vector2u pixels = backgroundLayer.getSize();
+    backgroundLayerSprite->setScale({view.getSize().x / pixels.x, view.getSize().y / pixels.y});
+    backgroundLayerSprite->setPosition(view.getCenter() - view.getSize() / 2.f);
+}
+
+void Game::drawBackground() {
+    PROFILE_SCOPE("drawBackground");
+    if (backgroundLayerSprite) {
+        frameTarget->draw(*backgroundLayerSprite);
+        return;
+    }
+    // Fallback when render textures are unavailable
+    if (texturesLoaded && backgroundSprite) {
+        frameTarget->draw(*backgroundSprite);
+    }
+    if (boardFitsView()) {
+        updateCamera();
+        frameTarget->setView(boardView);
+        drawGrid();
+        flushBoard(*frameTarget);
+        frameTarget->setView(uiView);
+    }
+}
+
+// Safe to call on a worker thread. A font that fails to open comes back
+// empty, and is cached that way so it is not retried.
+std::shared_ptr<Game::LoadedFont> Game::openFont(const std::string& path) const {
+    auto loaded = std::make_shared<LoadedFont>();
+    bool opened = false;
+    if (const AssetBundle::Entry* packed = bundle.find(path, AssetBundle::RAW)) {
+        // Bundled fonts are read straight from the mapping
+        opened = loaded->font.openFromMemory(packed->data, packed->size);
+    } else {
+        // openFromFile would keep streaming glyphs from disk; hold the bytes instead
+        std::ifstream in(path, std::ios::binary);
+        loaded->bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        opened = !loaded->bytes.empty() && loaded->font.openFromMemory(loaded->bytes.data(), loaded->bytes.size());
+    }
+    if (!opened) {
+        std::cerr << "Warning: Could not load font: " << path << std::endl;
+    }
+    return loaded;
+}
+
+const sf::Font& Game::loadFont(int index) {
+    if (!fontCache[index]) fontCache[index] = openFont(fontPaths[index]);
+    return fontCache[index]->font;
+}
+
+void Game::applyFont() {
+    PROFILE_SCOPE("applyFont");
+    if (fontPaths.empty()) return;
+    hud.setFont(loadFont(currentFontIndex));
 }
 
 void Game::run() {
@@ -274,272 +657,1213 @@ void Game::run() {
         std::cerr << "Failed to initialize game!" << std::endl;
         return;
     }
-    while (window.isOpen()) {
+    publishFrame();
+    // The render thread takes the window's GL context from here on
+    if (!encoder) {
+        if (!window.setActive(false)) {
+            std::cerr << "Warning: Could not release the GL context; rendering on the main thread" << std::endl;
+        } else {
+            renderThread = std::thread(&Game::renderLoop, this);
+        }
+    }
+    mainUsage.start();
+    while (!quitRequested) {
+        pollLoadedAudio();
+        pollNetwork();
         handleEvents();
         update();
-        render();
+        publishFrame();
+#ifdef SNAKE_PROFILE
+        audioManager.pollLatency();
+#endif
+        if (!renderThread.joinable()) {
+            snapshots.update();
+            render(snapshots.read());
+            PROFILE_FRAME();
+            mainUsage.charge(gameState, true, true);
+        } else {
+            mainUsage.charge(gameState, false, true);
+            if (!turbo) waitForInput();
+        }
     }
+    stopRenderThread();
+    logUsage();
+    finishRecording();
+    finishCapture();
+    window.close();
+    if (netClient) netClient->disconnect();
 }
 
-void Game::handleEvents() {
-    while (auto evOpt = window.pollEvent()) {
-        const sf::Event& event = *evOpt;
-        if (event.is<sf::Event::Closed>()) {
-            window.close();
-            continue;
+// Copies what the render thread needs out of the game and hands it over,
+// unless nothing on screen would change
+void Game::publishFrame() {
+    PROFILE_SCOPE("publishFrame");
+    const FrameKey key = frameKey();
+    // The profiler overlay shows live numbers, so it is always republished
+    if (keyPublished && key == publishedKey && !key.profilerOverlay) return;
+    publishedKey = key;
+    keyPublished = true;
+    fillSnapshot(snapshots.write());
+    snapshots.publish();
+    wakeRenderer();
+}
+
+// Everything a snapshot shows that does not follow from the time since it
+// was published. The cells copied follow from the game and its tick.
+Game::FrameKey Game::frameKey() const {
+    FrameKey key;
+    key.state = gameState;
+    key.turbo = turbo;
+    key.rewinding = rewinding;
+#ifdef SNAKE_PROFILE
+    key.profilerOverlay = profilerOverlay;
+#else
+    key.profilerOverlay = false;
+#endif
+    if (arena) {
+        key.game = 0;
+        key.ticks = arena->getStats().ticks;
+        key.follow = arenaFollow;
+    } else {
+        key.game = netClient ? netGame : sim.getSeed();
+        key.ticks = sim.getTicks();
+        key.follow = 0;
+    }
+    key.redraws = redraws;
+    key.fontIndex = selectedFont;
+    key.windowSize = windowSize;
+    std::memcpy(key.score, scoreText, sizeof(key.score));
+    return key;
+}
+
+bool Game::FrameKey::operator==(const FrameKey& other) const {
+    return state == other.state && turbo == other.turbo && rewinding == other.rewinding &&
+           profilerOverlay == other.profilerOverlay && game == other.game && ticks == other.ticks &&
+           follow == other.follow && redraws == other.redraws && fontIndex == other.fontIndex &&
+           windowSize == other.windowSize && std::strcmp(score, other.score) == 0;
+}
+
+void Game::wakeRenderer() {
+    {
+        std::lock_guard<std::mutex> lock(renderMutex);
+        renderRequested = true;
+    }
+    renderWake.notify_one();
+}
+
+// In states where nothing moves by itself, blocks until the next event (or
+// until the autopilot or arena restarts); otherwise sleeps one poll
+// interval, so input is picked up and a tick is late by at most that.
+void Game::waitForInput() {
+    const bool ended = gameState == GameState::GAME_OVER || gameState == GameState::WON;
+    bool idle = (gameState == GameState::MENU || gameState == GameState::PAUSED || ended) &&
+                !rewinding && !netClient && assetsPending.load(std::memory_order_relaxed) == 0;
+#ifdef SNAKE_PROFILE
+    idle = idle && !profilerOverlay;
+#endif
+    sf::Time timeout = sf::Time::Zero;  // no timeout
+    if (idle && (autopilot || arena) && gameState != GameState::PAUSED) {
+        timeout = sf::seconds(AUTOPILOT_RESTART_DELAY) - gameEndClock.getElapsedTime();
+        idle = ended && timeout > sf::Time::Zero;
+    }
+    if (!idle) {
+        sf::sleep(sf::seconds(INPUT_POLL_INTERVAL));
+        return;
+    }
+    const std::optional<sf::Event> event = window.waitEvent(timeout);
+    mainUsage.charge(gameState, false, false);
+    if (event) handleEvent(*event);
+}
+
+void Game::fillSnapshot(FrameSnapshot& out) const {
+    out.state = gameState;
+    out.turbo = turbo;
+    out.arena = arena != nullptr;
+    out.published = sharedClock.getElapsedTime();
+    out.alpha = renderAlpha;
+    out.alphaRate = 0.f;
+    if (gameState == GameState::PLAYING && !turbo && !arena) {
+        out.alphaRate = (rewinding ? -REWIND_RATE : 1.f) / tickDuration().asSeconds();
+    }
+    std::memcpy(out.score, scoreText, sizeof(out.score));
+    out.windowSize = windowSize;
+    out.fontIndex = selectedFont;
+#ifdef SNAKE_PROFILE
+    out.profilerOverlay = profilerOverlay;
+    out.audio = audioManager.latencyStats();
+#endif
+
+    if (arena) {
+        out.follow = arenaFollow;
+        if (const ArenaSnake* followed = followedSnake()) {
+            const int cell = followed->head();
+            out.head = out.neck = out.tail = out.lastTail = Position(cell % gridWidth, cell / gridWidth);
+            out.length = followed->getLength();
+        } else {
+            // Nobody to follow: hold the camera on the middle of the board
+            out.head = out.neck = out.tail = out.lastTail = Position(gridWidth / 2, gridHeight / 2);
+            out.length = 0;
         }
-        if (auto keyPressed = event.getIf<sf::Event::KeyPressed>()) {
-            switch (keyPressed->code) {
-                case sf::Keyboard::Key::Escape:
-                    window.close();
-                    break;
-                case sf::Keyboard::Key::Space:
-                    if (gameState == GameState::MENU || gameState == GameState::GAME_OVER) {
-                        resetGame();
-                        gameState = GameState::PLAYING;
-                    }
-                    break;
-                case sf::Keyboard::Key::P:
-                    if (gameState == GameState::PLAYING) {
-                        gameState = GameState::PAUSED;
-                    } else if (gameState == GameState::PAUSED) {
-                        gameState = GameState::PLAYING;
-                    }
-                    break;
-                case sf::Keyboard::Key::S:
-                    audioManager.toggleSound();
-                    break;
-                case sf::Keyboard::Key::M:
-                    audioManager.toggleMusic();
-                    break;
-                case sf::Keyboard::Key::F:
-                    if (!fontPaths.empty()) {
-                        currentFontIndex = (currentFontIndex + 1) % fontPaths.size();
-                        applyFont();
-                    }
-                    break;
-                case sf::Keyboard::Key::Up:
-                    if (gameState == GameState::PLAYING) { snake.setDirection(Direction::UP); audioManager.playMoveSound(); }
-                    break;
-                case sf::Keyboard::Key::Down:
-                    if (gameState == GameState::PLAYING) { snake.setDirection(Direction::DOWN); audioManager.playMoveSound(); }
-                    break;
-                case sf::Keyboard::Key::Left:
-                    if (gameState == GameState::PLAYING) { snake.setDirection(Direction::LEFT); audioManager.playMoveSound(); }
-                    break;
-                case sf::Keyboard::Key::Right:
-                    if (gameState == GameState::PLAYING) { snake.setDirection(Direction::RIGHT); audioManager.playMoveSound(); }
-                    break;
-                default:
-                    break;
+    } else {
+        const Snake& snake = sim.getSnake();
+        const SnakeBody body = snake.getBody();
+        out.length = body.size();
+        if (!body.empty()) {
+            out.head = body[0];
+            out.neck = body.size() > 1 ? body[1] : body[0];
+            out.tail = body.back();
+            out.lastTail = snake.getLastTail();
+        }
+        out.fruit = sim.getFruit().getPosition();
+    }
+
+    // Every cell a camera on the head at any alpha can see
+    const sf::Vector2f half(CELL_SIZE / 2.f, CELL_SIZE / 2.f);
+    const CellRect a = cellsUnder(cameraCenter(gridToPixel(out.head) + half));
+    const CellRect b = cellsUnder(cameraCenter(gridToPixel(out.neck) + half));
+    const CellRect r{std::min(a.x0, b.x0), std::min(a.y0, b.y0), std::max(a.x1, b.x1), std::max(a.y1, b.y1)};
+    out.cells = r;
+    out.owners.assign(static_cast<std::size_t>((r.x1 - r.x0) * (r.y1 - r.y0)), FREE_CELL);
+    std::int32_t* owner = out.owners.data();
+    if (arena) {
+        for (int y = r.y0; y < r.y1; ++y) {
+            for (int x = r.x0; x < r.x1; ++x, ++owner) {
+                const int cell = y * gridWidth + x;
+                const int id = arena->ownerAt(cell);
+                if (id >= 0) {
+                    *owner = (id << 1) | (arena->getSnake(id).head() == cell ? 1 : 0);
+                } else if (arena->hasFruit(cell)) {
+                    *owner = FRUIT_CELL;
+                }
             }
         }
+        return;
+    }
+    const BitBoard& occupancy = sim.getSnake().getOccupancy();
+    const size_t width = static_cast<size_t>(gridWidth);
+    const int stride = r.x1 - r.x0;
+    for (int y = r.y0; y < r.y1; ++y) {
+        const size_t row = y * width;
+        std::int32_t* rowOwners = owner + (y - r.y0) * stride;
+        occupancy.forEachSet(row + r.x0, row + r.x1, [&](size_t cell) { rowOwners[cell - row - r.x0] = 0; });
     }
 }
 
-void Game::update() {
-    if (gameState != GameState::PLAYING) {
+void Game::renderLoop() {
+    if (!window.setActive(true)) {
+        std::cerr << "Error: Could not activate the GL context on the render thread" << std::endl;
         return;
     }
-    
-    sf::Time elapsed = gameClock.getElapsedTime();
-    if (elapsed - lastUpdate >= sf::milliseconds(static_cast<int>(gameSpeed))) {
-    prevSnakeBody = snake.getBody();
-    snake.move();
-        
-        // Check wall collision
-        const Position& head = snake.getHead();
-        if (!isValidPosition(head)) {
-            audioManager.playGameOverSound();
-            gameState = GameState::GAME_OVER;
+    renderUsage.start();
+    bool woken = true;
+    bool moving = true;     // the last frame's alpha had not reached its end
+    while (!renderStop.load(std::memory_order_acquire)) {
+        {
+            // A wake-up from here on is for a later snapshot
+            std::lock_guard<std::mutex> lock(renderMutex);
+            renderRequested = false;
+        }
+        const bool fresh = snapshots.update();
+        const FrameSnapshot& snapshot = snapshots.read();
+        if (fresh || woken || moving) {
+            render(snapshot);
+            PROFILE_FRAME();
+            renderUsage.charge(snapshot.state, true, woken);
+            woken = false;
+            moving = (snapshot.alphaRate > 0.f && frameAlpha < 1.f) || (snapshot.alphaRate < 0.f && frameAlpha > 0.f);
+#ifdef SNAKE_PROFILE
+            moving = moving || snapshot.profilerOverlay;
+#endif
+            // Turbo leaves the core to the game, redrawing a few times a second
+            if (snapshot.turbo) sf::sleep(sf::seconds(TURBO_RENDER_INTERVAL));
+            continue;
+        }
+        // Nothing on screen would change: sleep until a snapshot or asset arrives
+        std::unique_lock<std::mutex> lock(renderMutex);
+        renderWake.wait(lock, [this] { return renderRequested; });
+        lock.unlock();
+        renderUsage.charge(snapshot.state, false, false);
+        woken = true;
+    }
+    (void)window.setActive(false);
+}
+
+// Joins the render thread and gives the GL context back to this one
+void Game::stopRenderThread() {
+    if (!renderThread.joinable()) return;
+    renderStop.store(true, std::memory_order_release);
+    wakeRenderer();
+    renderThread.join();
+    (void)window.setActive(true);
+}
+
+namespace {
+
+// CPU time used by the calling thread; 0 where it cannot be read
+double threadCpuSeconds() {
+#if !defined(_WIN32)
+    timespec now{};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) != 0) return 0.0;
+    return static_cast<double>(now.tv_sec) + now.tv_nsec / 1e9;
+#else
+    return 0.0;
+#endif
+}
+
+const char* const STATE_NAMES[] = { "menu", "playing", "paused", "game over", "won" };
+
+} // namespace
+
+// UsageMeter Implementation
+void Game::UsageMeter::start() {
+    wall.restart();
+    lastCpu = threadCpuSeconds();
+}
+
+void Game::UsageMeter::charge(GameState state, bool drewFrame, bool wokeUp) {
+    Entry& entry = states[static_cast<int>(state)];
+    entry.wallSeconds += wall.restart().asSeconds();
+    const double cpu = threadCpuSeconds();
+    entry.cpuSeconds += cpu - lastCpu;
+    lastCpu = cpu;
+    if (drewFrame) ++entry.frames;
+    if (wokeUp) ++entry.wakeups;
+}
+
+// One line per state the game spent time in. Rendered frames are counted
+// on the main thread when it renders itself (a capture).
+void Game::logUsage() const {
+    for (int i = 0; i < STATE_COUNT; ++i) {
+        const UsageMeter::Entry& main = mainUsage.states[i];
+        const UsageMeter::Entry& render = renderUsage.states[i];
+        if (main.wallSeconds <= 0.0) continue;
+        const double renderWall = std::max(render.wallSeconds, 1e-9);
+        char line[192];
+        std::snprintf(line, sizeof(line),
+                      "Usage: %-9s %8.1f s | main %5.1f%% cpu, %7.1f wakeups/s | render %5.1f%% cpu, %6.1f frames/s",
+                      STATE_NAMES[i], main.wallSeconds, 100.0 * main.cpuSeconds / main.wallSeconds,
+                      main.wakeups / main.wallSeconds, 100.0 * render.cpuSeconds / renderWall,
+                      (render.frames + main.frames) / main.wallSeconds);
+        std::cout << line << std::endl;
+    }
+}
+
+bool Game::loadReplay(const std::string& path, bool turboMode) {
+    if (!replayReader.open(path)) {
+        std::cerr << "Error: Could not read replay: " << path << std::endl;
+        return false;
+    }
+    if (!isValidBoardSize(replayReader.getGridWidth(), replayReader.getGridHeight())) {
+        std::cerr << "Error: Unsupported replay board " << replayReader.getGridWidth() << "x"
+                  << replayReader.getGridHeight() << std::endl;
+        return false;
+    }
+    // Play on the board the replay was recorded on
+    gridWidth = replayReader.getGridWidth();
+    gridHeight = replayReader.getGridHeight();
+    sim = SnakeSim(gridWidth, gridHeight, replayReader.getSeed());
+    replayPlayer = std::make_unique<ReplayPlayer>(replayReader, sim);
+    turbo = turboMode;
+    gameState = GameState::PLAYING;
+    return true;
+}
+
+void Game::finishRecording() {
+    if (!recorder.isRecording()) return;
+    recorder.finish(sim.getTicks());
+    std::error_code ec;
+    std::filesystem::create_directories("replays", ec);
+    std::string path = "replays/replay-" + std::to_string(sim.getSeed()) + ".snkr";
+    if (!recorder.save(path)) {
+        std::cerr << "Warning: Could not save replay: " << path << std::endl;
+    }
+}
+
+void Game::seekReplay(std::int64_t deltaTicks) {
+    std::int64_t target = std::max<std::int64_t>(0, static_cast<std::int64_t>(sim.getTicks()) + deltaTicks);
+    replayPlayer->seek(static_cast<std::uint64_t>(target));
+    gameState = replayPlayer->isFinished() ? GameState::GAME_OVER : GameState::PLAYING;
+    tickAccumulator = sf::Time::Zero;
+    renderAlpha = 1.f;
+    updateScore();
+}
+
+void Game::handleEvents() {
+    PROFILE_SCOPE("handleEvents");
+    while (auto event = window.pollEvent()) handleEvent(*event);
+}
+
+void Game::handleEvent(const sf::Event& event) {
+    if (event.is<sf::Event::Closed>()) {
+        quitRequested = true;
+        return;
+    }
+    // The render thread resizes its layers when the snapshot says so
+    if (event.is<sf::Event::Resized>()) {
+        windowSize = window.getSize();
+        return;
+    }
+    // What was on screen may have been covered; draw it again
+    if (event.is<sf::Event::FocusGained>()) {
+        ++redraws;
+        return;
+    }
+    // The release of a held R may never arrive once focus has gone
+    if (event.is<sf::Event::FocusLost>()) {
+        stopRewind();
+        return;
+    }
+    if (auto keyReleased = event.getIf<sf::Event::KeyReleased>()) {
+        if (keyReleased->code == sf::Keyboard::Key::R) stopRewind();
+        return;
+    }
+    if (auto keyPressed = event.getIf<sf::Event::KeyPressed>()) {
+        switch (keyPressed->code) {
+            case sf::Keyboard::Key::Escape:
+                quitRequested = true;
+                break;
+            case sf::Keyboard::Key::T:
+                if (replayPlayer && !encoder) turbo = !turbo;
+                break;
+#ifdef SNAKE_PROFILE
+            case sf::Keyboard::Key::F3:
+                profilerOverlay = !profilerOverlay;
+                break;
+            case sf::Keyboard::Key::F4:
+                dumpTrace();
+                break;
+#endif
+            case sf::Keyboard::Key::Space:
+                if (gameState == GameState::MENU || gameState == GameState::GAME_OVER || gameState == GameState::WON) {
+                    resetGame();
+                    gameState = GameState::PLAYING;
+                }
+                break;
+            case sf::Keyboard::Key::P:
+                if (gameState == GameState::PLAYING) {
+                    gameState = GameState::PAUSED;
+                } else if (gameState == GameState::PAUSED) {
+                    gameState = GameState::PLAYING;
+                }
+                break;
+            case sf::Keyboard::Key::S:
+                audioManager.toggleSound();
+                updateScore();
+                break;
+            case sf::Keyboard::Key::M:
+                audioManager.toggleMusic();
+                updateScore();
+                break;
+            case sf::Keyboard::Key::F:
+                if (!fontPaths.empty()) {
+                    selectedFont = (selectedFont + 1) % static_cast<int>(fontPaths.size());
+                }
+                break;
+            case sf::Keyboard::Key::A:
+                setAutopilot(!autopilot);
+                break;
+            case sf::Keyboard::Key::R:
+                startRewind();
+                break;
+            case sf::Keyboard::Key::Up:
+                if (replayPlayer) break;
+                playerTurn(Direction::UP);
+                break;
+            case sf::Keyboard::Key::Down:
+                if (replayPlayer) break;
+                playerTurn(Direction::DOWN);
+                break;
+            case sf::Keyboard::Key::Left:
+                if (replayPlayer) { seekReplay(-REPLAY_SEEK_TICKS); break; }
+                playerTurn(Direction::LEFT);
+                break;
+            case sf::Keyboard::Key::Right:
+                if (replayPlayer) { seekReplay(REPLAY_SEEK_TICKS); break; }
+                playerTurn(Direction::RIGHT);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void Game::startRewind() {
+    const bool ended = gameState == GameState::GAME_OVER || gameState == GameState::WON;
+    if (rewinding || replayPlayer || arena || netClient || rewind.size() == 0 ||
+        (gameState != GameState::PLAYING && !ended)) {
+        return;
+    }
+    // Like an arrow key, taking the game back takes it from the autopilot
+    setAutopilot(false);
+    rewinding = true;
+    gameState = GameState::PLAYING;
+    updateScore();
+}
+
+// The fixed-timestep loop run backwards: renderAlpha falls from 1 to 0
+// across a tick, which is then undone and drawn from its end again
+void Game::stepRewind(sf::Time frameTime) {
+    const float elapsed = std::min(frameTime, sf::seconds(MAX_FRAME_TIME)).asSeconds();
+    renderAlpha -= REWIND_RATE * elapsed / tickDuration().asSeconds();
+    bool undone = false;
+    while (renderAlpha < 0.f) {
+        if (!rewind.undo(sim)) {
+            // History used up: hold here until R is let go
+            renderAlpha = 0.f;
+            break;
+        }
+        renderAlpha += 1.f;
+        undone = true;
+    }
+    if (sim.getTicks() == 0) renderAlpha = 1.f;
+    if (undone) updateScore();
+}
+
+void Game::stopRewind() {
+    if (!rewinding) return;
+    rewinding = false;
+    recorder.truncate(sim.getTicks());
+    // Play on from the frame on screen
+    tickAccumulator = sim.getTicks() == 0 ? sf::Time::Zero : sf::seconds(tickDuration().asSeconds() * renderAlpha);
+    updateScore();
+}
+
+void Game::playerTurn(Direction dir) {
+    if (gameState != GameState::PLAYING || arena) return;
+    // Steering by hand takes over from the autopilot
+    setAutopilot(false);
+    if (sim.queueDirection(dir)) audioManager.playMoveSound();
+}
+
+void Game::setAutopilot(bool enabled) {
+    if (enabled == static_cast<bool>(autopilot) || (enabled && (replayPlayer || arena))) return;
+    if (enabled) {
+        const auto budget = std::chrono::microseconds(static_cast<std::int64_t>(AUTOPILOT_BUDGET_MS * 1000.f));
+        autopilot = std::make_unique<AutopilotWorker>(gridWidth, gridHeight, budget);
+        autopilotLateTicks = 0;
+        autopilot->request(sim);
+    } else {
+        logAutopilotStats();
+        autopilot.reset();
+    }
+    updateScore();
+}
+
+void Game::setArena(std::size_t snakeCount, unsigned threads) {
+    setAutopilot(false);
+    arena = std::make_unique<Arena>(gridWidth, gridHeight, snakeCount, std::max<std::size_t>(1, snakeCount / 2), threads);
+    arena->reset(std::random_device{}());
+    arenaFollow = 0;
+    followLiveSnake();
+    std::cout << "Arena: " << arena->getSnakeCount() << " snakes on " << gridWidth << "x" << gridHeight << ", "
+              << arena->getThreadCount() << " threads" << std::endl;
+    updateScore();
+}
+
+// Moves the camera on to the next living snake by id when the followed one
+// is dead; stays put when none is alive
+void Game::followLiveSnake() {
+    const std::size_t count = arena->getSnakeCount();
+    for (std::size_t n = 0; n < count && !arena->getSnake(arenaFollow).isAlive(); ++n) {
+        arenaFollow = (arenaFollow + 1) % count;
+    }
+}
+
+const ArenaSnake* Game::followedSnake() const {
+    if (arenaFollow >= arena->getSnakeCount()) return nullptr;
+    const ArenaSnake& snake = arena->getSnake(arenaFollow);
+    return snake.isAlive() ? &snake : nullptr;
+}
+
+bool Game::connect(const std::string& address) {
+    NetAddress server;
+    if (!NetAddress::parse(address, server)) {
+        std::cerr << "Error: --connect expects host:port, got " << address << std::endl;
+        return false;
+    }
+    netClient = std::make_unique<NetClient>(sim);
+    if (!netClient->connect(server, gridWidth, gridHeight)) {
+        std::cerr << "Error: Could not open a UDP socket" << std::endl;
+        netClient.reset();
+        return false;
+    }
+    std::cout << "Info: connecting to " << server.toString() << std::endl;
+    return true;
+}
+
+void Game::pollNetwork() {
+    if (!netClient) return;
+    netClient->receive();
+    if (!netClient->isReady()) return;
+    // A reconciliation can move the snake without changing its tick, game
+    // or score, so nothing else in the frame key would notice
+    const std::uint64_t mispredictions = netClient->getStats().mispredictions;
+    if (mispredictions != netMispredictions) {
+        netMispredictions = mispredictions;
+        ++redraws;
+    }
+    if (netClient->getGame() != netGame) {
+        netGame = netClient->getGame();
+        if (sim.getGridWidth() != gridWidth || sim.getGridHeight() != gridHeight) {
+            std::cerr << "Warning: server board is " << sim.getGridWidth() << "x" << sim.getGridHeight()
+                      << ", not " << gridWidth << "x" << gridHeight << "; playing offline" << std::endl;
+            netClient.reset();
+            sim = SnakeSim(gridWidth, gridHeight, std::random_device{}());
+            gameState = GameState::MENU;
             return;
         }
-        
-        // Check self collision
-        if (snake.checkSelfCollision()) {
-            audioManager.playGameOverSound();
-            gameState = GameState::GAME_OVER;
+        if (gameState != GameState::MENU) gameState = GameState::PLAYING;
+        tickAccumulator = sf::Time::Zero;
+        renderAlpha = 1.f;
+        updateScore();
+    }
+    // A reconciliation can take back a predicted death
+    const bool ended = gameState == GameState::GAME_OVER || gameState == GameState::WON;
+    if (ended && !sim.isOver() && netClient->canStep()) {
+        gameState = GameState::PLAYING;
+        updateScore();
+    }
+}
+
+// Sets the direction for the tick about to run from the worker's plan
+void Game::steerAutopilot() {
+    Direction dir;
+    if (autopilot->poll(sim, dir)) {
+        sim.setDirection(dir);
+        return;
+    }
+    // Not planned yet: rather than wait, go straight if that is safe, else
+    // take any safe turn. The worker picks up again from the next request.
+    ++autopilotLateTicks;
+    if (isSafeMove(sim, sim.getSnake().getDirection())) return;
+    for (Direction turn : { Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT }) {
+        if (isSafeMove(sim, turn)) {
+            sim.setDirection(turn);
             return;
         }
-        
-        // Check fruit collision
-        if (head == fruit.getPosition()) {
+    }
+}
+
+void Game::logAutopilotStats() {
+    const AutopilotStats stats = autopilot->getStats();
+    if (stats.ticks == 0) return;
+    std::cout << "Autopilot: " << stats.ticks << " ticks planned, " << stats.totalNs / 1000 / stats.ticks
+              << " us mean / " << stats.maxNs / 1000 << " us max per tick, " << stats.searches << " searches, "
+              << stats.fallbacks << " fallbacks, " << stats.overBudget << " over budget, "
+              << autopilotLateTicks << " late" << std::endl;
+}
+
+sf::Time Game::tickDuration() const {
+    return sf::microseconds(static_cast<std::int64_t>(sim.getGameSpeed() * 1000.f));
+}
+
+// Runs one simulation tick and reacts to its outcome. Returns false once
+// the game has ended, or while an online game waits for the server.
+bool Game::advanceTick() {
+    PROFILE_SCOPE("advanceTick");
+    if (arena) {
+        // Snakes respawn, so an arena never ends
+        arena->step();
+        followLiveSnake();
+        updateScore();
+        return true;
+    }
+    StepResult result;
+    if (netClient) {
+        if (!netClient->canStep()) {
+            // Let the server catch up instead of bursting ticks afterwards
+            tickAccumulator = sf::Time::Zero;
+            return false;
+        }
+        if (autopilot) steerAutopilot();
+        result = netClient->step();
+        if (autopilot && !sim.isOver()) autopilot->request(sim);
+    } else if (replayPlayer) {
+        if (replayPlayer->isFinished()) {
+            // Recording stopped before the game ended
+            gameState = GameState::GAME_OVER;
+            renderAlpha = 1.f;
+            return false;
+        }
+        result = replayPlayer->step();
+    } else {
+        if (autopilot) steerAutopilot();
+        Direction before = sim.getSnake().getDirection();
+        result = rewind.step(sim);
+        if (sim.getSnake().getDirection() != before) {
+            recorder.record(sim.getTicks(), sim.getSnake().getDirection());
+        }
+        // Plan the next tick while this one is on screen
+        if (autopilot && !sim.isOver()) autopilot->request(sim);
+    }
+    switch (result) {
+        case StepResult::MOVED:
+            return true;
+        case StepResult::ATE:
+            if (!turbo) audioManager.playEatSound();
+            updateScore();
+            return true;
+        case StepResult::HIT_WALL:
+        case StepResult::HIT_SELF:
+            audioManager.playGameOverSound();
+            gameState = GameState::GAME_OVER;
+            break;
+        case StepResult::WON:
             audioManager.playEatSound();
-            snake.grow();
-            fruit.respawn(snake.getBody());
             updateScore();
+            gameState = GameState::WON;
+            break;
+    }
+    renderAlpha = 1.f;
+    gameEndClock.restart();
+    logInputStats();
+    if (autopilot) logAutopilotStats();
+    finishRecording();
+    return false;
+}
+
+void Game::update() {
+    PROFILE_SCOPE("update");
+    // Always restart the frame clock so time spent in menus or paused is
+    // never fed into the simulation.
+    sf::Time frameTime = frameClock.restart();
+    // A capture advances by exactly one frame of its clip, however long the
+    // frame really took
+    if (encoder) frameTime = sf::seconds(1.f / captureFps);
+    if (rewinding) {
+        stepRewind(frameTime);
+        return;
+    }
+    // Unattended play: the autopilot or arena starts the next game by itself
+    const bool ended = gameState == GameState::GAME_OVER || gameState == GameState::WON;
+    if ((autopilot || arena) && (gameState == GameState::MENU ||
+                      (ended && gameEndClock.getElapsedTime().asSeconds() >= AUTOPILOT_RESTART_DELAY))) {
+        resetGame();
+        gameState = GameState::PLAYING;
+    }
+    if (gameState != GameState::PLAYING) {
+        return;
+    }
+    
+    if (turbo) {
+        for (int i = 0; i < TURBO_TICKS_PER_FRAME; ++i) {
+            if (!advanceTick()) return;
         }
-        
-        lastUpdate = elapsed;
+        renderAlpha = 1.f;
+        return;
+    }
+    
+    tickAccumulator += std::min(frameTime, sf::seconds(MAX_FRAME_TIME));
+    for (sf::Time tick = tickDuration(); tickAccumulator >= tick; tick = tickDuration()) {
+        tickAccumulator -= tick;
+        if (!advanceTick()) return;
     }
+    renderAlpha = sim.getTicks() == 0 ? 1.f : tickAccumulator.asSeconds() / tickDuration().asSeconds();
 }
 
-void Game::render() {
-    window.clear(sf::Color::Black);
-    if (texturesLoaded && backgroundSprite) {
-        window.draw(*backgroundSprite);
+void Game::render(const FrameSnapshot& snapshot) {
+    PROFILE_SCOPE("render");
+    frame = &snapshot;
+    const float sincePublished = (sharedClock.getElapsedTime() - snapshot.published).asSeconds();
+    frameAlpha = std::clamp(snapshot.alpha + snapshot.alphaRate * sincePublished, 0.f, 1.f);
+    pollLoadedAssets();
+    if (snapshot.windowSize != layerSize) {
+        layerSize = snapshot.windowSize;
+        rebuildBackgroundLayer();
+        hud.resize(layerSize);
+    }
+    if (snapshot.fontIndex != currentFontIndex) {
+        currentFontIndex = snapshot.fontIndex;
+        applyFont();
+    }
+    if (encoder) {
+        frameTarget = &captureTextures[captureFrames % CAPTURE_TEXTURES];
+    } else {
+        frameTarget = &window;
     }
+    frameTarget->clear(sf::Color::Black);
+    frameTarget->setView(uiView);
     
-    switch (gameState) {
+    switch (snapshot.state) {
         case GameState::MENU:
-            if (menuText) window.draw(*menuText);
+            if (texturesLoaded && backgroundSprite) {
+                frameTarget->draw(*backgroundSprite);
+            }
             break;
             
         case GameState::PLAYING:
         case GameState::PAUSED:
-            drawGrid();
-            drawFruit();
-            drawSnake();
-            drawUI();
-            
-            if (gameState == GameState::PAUSED) {
-                if (pauseText) window.draw(*pauseText);
-            }
+            drawBackground();
+            drawBoard(true);
             break;
             
         case GameState::GAME_OVER:
-            drawGrid();
-            drawFruit();
-            drawSnake();
-            drawUI();
-            if (gameOverText) window.draw(*gameOverText);
-            
-            sf::Text restartText(font, "Press SPACE to Restart", 24);
-            restartText.setFillColor(sf::Color::White);
-            sf::FloatRect textRect = restartText.getLocalBounds();
-            restartText.setOrigin({textRect.position.x + textRect.size.x / 2.0f, textRect.position.y + textRect.size.y / 2.0f});
-            restartText.setPosition({WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f + 50});
-            window.draw(restartText);
+        case GameState::WON:
+            drawBackground();
+            drawBoard(snapshot.state == GameState::GAME_OVER);
             break;
     }
+    drawUI();
     
-    window.display();
+#ifdef SNAKE_PROFILE
+    if (snapshot.profilerOverlay) drawProfilerOverlay();
+#endif
+    if (encoder) {
+        presentCapture();
+    } else {
+        PROFILE_SCOPE("display");
+        window.display();
+    }
+    if (!firstFrameLogged) {
+        firstFrameLogged = true;
+        std::cout << "Startup: first frame after " << startupClock.getElapsedTime().asMilliseconds() << " ms ("
+                  << (bundle.isOpen() ? "asset bundle" : "loose assets") << ")" << std::endl;
+    }
+}
+
+bool Game::startCapture(const std::string& path, unsigned fps) {
+    const sf::Vector2u size = window.getSize();
+    for (sf::RenderTexture& texture : captureTextures) {
+        if (!texture.resize(size)) {
+            std::cerr << "Error: Could not create the capture render textures" << std::endl;
+            return false;
+        }
+    }
+    encoder = std::make_unique<FrameEncoder>();
+    if (!encoder->open(path, size.x, size.y, CAPTURE_QUEUE_FRAMES)) {
+        std::cerr << "Error: Could not open capture output: " << path << std::endl;
+        encoder.reset();
+        return false;
+    }
+    captureFps = fps;
+    // Every frame is one fixed step of game time; turbo would skip frames
+    turbo = false;
+    std::cout << "Capture: " << size.x << "x" << size.y << " at " << fps << " fps to " << path << std::endl;
+    return true;
+}
+
+// Shows the frame just drawn, then reads back the one drawn
+// CAPTURE_TEXTURES - 1 frames ago, before its texture is drawn over
+void Game::presentCapture() {
+    sf::RenderTexture& drawn = captureTextures[captureFrames % CAPTURE_TEXTURES];
+    drawn.display();
+    {
+        PROFILE_SCOPE("display");
+        window.setView(window.getDefaultView());
+        window.clear(sf::Color::Black);
+        window.draw(sf::Sprite(drawn.getTexture()));
+        window.display();
+    }
+    ++captureFrames;
+    while (captureRead + CAPTURE_TEXTURES <= captureFrames) readBackCapture(captureRead++);
+
+    // A full game: stop CAPTURE_TAIL seconds after the first one ends
+    const bool ended = frame->state == GameState::GAME_OVER || frame->state == GameState::WON;
+    if (ended && captureStopFrame == 0) {
+        captureStopFrame = captureFrames + static_cast<std::uint64_t>(CAPTURE_TAIL * captureFps);
+    }
+    if (captureStopFrame != 0 && captureFrames >= captureStopFrame) quitRequested = true;
+}
+
+void Game::readBackCapture(std::uint64_t frame) {
+    PROFILE_SCOPE("captureReadback");
+    const sf::Clock timer;
+    const sf::Image image = captureTextures[frame % CAPTURE_TEXTURES].getTexture().copyToImage();
+    encoder->submit(image.getPixelsPtr());
+    const sf::Time elapsed = timer.getElapsedTime();
+    captureReadTime += elapsed;
+    captureReadMax = std::max(captureReadMax, elapsed);
+}
+
+void Game::finishCapture() {
+    if (!encoder) return;
+    while (captureRead < captureFrames) readBackCapture(captureRead++);
+    encoder->close();
+    const FrameEncoder::Stats stats = encoder->getStats();
+    const double frames = static_cast<double>(std::max<std::uint64_t>(captureFrames, 1));
+    std::cout << "Capture: " << stats.frames << " frames (" << stats.bytes / (1024 * 1024) << " MB) to "
+              << encoder->getPath() << "; readback " << captureReadTime.asSeconds() * 1000.0 / frames
+              << " ms per frame (max " << captureReadMax.asSeconds() * 1000.f << " ms), encoder "
+              << stats.encodeNs / 1e6 / std::max<std::uint64_t>(stats.frames, 1) << " ms per frame (max "
+              << stats.maxEncodeNs / 1e6 << " ms), " << stats.blockedSubmits << " frames waited "
+              << stats.blockedNs / 1e6 << " ms for a free buffer" << std::endl;
+    if (stats.failed) {
+        std::cerr << "Warning: Could not write every captured frame to " << encoder->getPath() << std::endl;
+    }
+    encoder.reset();
 }
 
 void Game::resetGame() {
-    snake.reset();
-    fruit.respawn(snake.getBody());
-    score = 0;
-    gameSpeed = BASE_SPEED;
-    lastUpdate = sf::Time::Zero;
-    gameClock.restart();
+    if (arena) {
+        arena->reset(std::random_device{}());
+        arenaFollow = 0;
+        followLiveSnake();
+    } else if (netClient) {
+        // A game already played needs a new one from the server, which
+        // starts when its WELCOME arrives
+        if (sim.getTicks() > 0) netClient->restart();
+    } else if (replayPlayer) {
+        replayPlayer->restart();
+    } else {
+        finishRecording();
+        sim.reset(std::random_device{}());
+        rewind.clear();
+        recorder.begin(gridWidth, gridHeight, sim.getSeed());
+        if (autopilot) autopilot->request(sim);
+    }
+    updateScore();
+    tickAccumulator = sf::Time::Zero;
+    renderAlpha = 1.f;
+    frameClock.restart();
+}
+
+void Game::logInputStats() const {
+    const InputStats& stats = sim.getInputStats();
+    std::cout << "Input: " << stats.applied << " applied, " << stats.dropped << " dropped, "
+              << stats.coalesced << " coalesced over " << sim.getTicks() << " ticks" << std::endl;
 }
 
+namespace {
+
+// Appends text or a number to a fixed buffer without touching the heap
+struct TextBuffer {
+    char data[96];
+    char* end = data;
+
+    TextBuffer& operator<<(const char* text) {
+        while (*text && end < data + sizeof(data) - 1) *end++ = *text++;
+        *end = '\0';
+        return *this;
+    }
+    TextBuffer& operator<<(int value) {
+        auto result = std::to_chars(end, data + sizeof(data) - 1, value);
+        if (result.ec == std::errc()) end = result.ptr;
+        *end = '\0';
+        return *this;
+    }
+};
+
+} // namespace
+
 void Game::updateScore() {
-    score += 10;
-    // Increase speed slightly with each fruit eaten
-    if (gameSpeed > 50.0f) {
-        gameSpeed -= SPEED_INCREASE;
+    TextBuffer text;
+    if (arena) {
+        text << "Arena: " << static_cast<int>(arena->getAliveCount()) << "/"
+             << static_cast<int>(arena->getSnakeCount()) << " alive | Tick: "
+             << static_cast<int>(arena->getStats().ticks);
+        if (const ArenaSnake* followed = followedSnake()) {
+            text << " | Following #" << static_cast<int>(arenaFollow)
+                 << " (" << static_cast<int>(followed->getLength()) << ")";
+        }
+        std::memcpy(scoreText, text.data, sizeof(scoreText));
+        return;
     }
-    
-    std::ostringstream ss;
-    ss << "Score: " << score << " | Speed: " << static_cast<int>(BASE_SPEED - gameSpeed + SPEED_INCREASE);
-    if (!audioManager.isSoundEnabled()) ss << " | Sound: OFF";
-    if (!audioManager.isMusicEnabled()) ss << " | Music: OFF";
-    if (scoreText) scoreText->setString(ss.str());
+    text << "Score: " << sim.getScore() << " | Speed: "
+         << static_cast<int>(SnakeSim::BASE_SPEED - sim.getGameSpeed() + SnakeSim::SPEED_INCREASE);
+    if (!audioManager.isSoundEnabled()) text << " | Sound: OFF";
+    if (!audioManager.isMusicEnabled()) text << " | Music: OFF";
+    if (autopilot) text << " | Autopilot";
+    if (rewinding) text << " | Rewind";
+    if (netClient) text << (netClient->isReady() ? " | Online" : " | Connecting");
+    std::memcpy(scoreText, text.data, sizeof(scoreText));
+}
+
+void Game::updateLoadingText(int pending) {
+    TextBuffer text;
+    text << "Loading assets " << (assetsTotal - pending) << "/" << assetsTotal;
+    hud.setString(Hud::LOADING, text.data);
+}
+
+bool Game::boardFitsView() const {
+    return gridWidth * CELL_SIZE <= WINDOW_WIDTH && gridHeight * CELL_SIZE <= WINDOW_HEIGHT;
+}
+
+// Top-left pixel of the head, slid in from the previous head cell (the
+// neck) by frameAlpha. Arena snakes are not interpolated.
+sf::Vector2f Game::headPixel() const {
+    sf::Vector2f headPos = gridToPixel(frame->head);
+    if (frame->length > 1 && frameAlpha < 1.f) {
+        sf::Vector2f from = gridToPixel(frame->neck);
+        headPos = from + (headPos - from) * frameAlpha;
+    }
+    return headPos;
+}
+
+void Game::updateCamera() {
+    aimCamera(cameraCenter(headPixel() + sf::Vector2f(CELL_SIZE / 2.f, CELL_SIZE / 2.f)));
+}
+
+void Game::aimCamera(sf::Vector2f center) {
+    boardView.setSize({static_cast<float>(WINDOW_WIDTH), static_cast<float>(WINDOW_HEIGHT)});
+    boardView.setCenter(center);
+    visibleCells = cellsUnder(center);
+}
+
+// View centre following the head's centre pixel
+sf::Vector2f Game::cameraCenter(sf::Vector2f head) const {
+    auto follow = [](float target, float view, float board) {
+        if (board <= view) return board / 2.f;
+        // Whole pixels keep the 1px grid lines from shimmering while scrolling
+        return std::round(std::clamp(target, view / 2.f, board - view / 2.f));
+    };
+    return sf::Vector2f(follow(head.x, static_cast<float>(WINDOW_WIDTH), static_cast<float>(gridWidth * CELL_SIZE)),
+                        follow(head.y, static_cast<float>(WINDOW_HEIGHT), static_cast<float>(gridHeight * CELL_SIZE)));
+}
+
+// visibleCells, within the cells the snapshot copied
+Game::CellRect Game::visibleSnapshotCells() const {
+    const CellRect& v = visibleCells;
+    const CellRect& c = frame->cells;
+    return CellRect{std::max(v.x0, c.x0), std::max(v.y0, c.y0), std::min(v.x1, c.x1), std::min(v.y1, c.y1)};
+}
+
+Game::CellRect Game::cellsUnder(sf::Vector2f center) const {
+    const sf::Vector2f viewSize(static_cast<float>(WINDOW_WIDTH), static_cast<float>(WINDOW_HEIGHT));
+    // Cells under the view plus a one-cell margin for the enlarged head and
+    // fruit sprites, widened to whole chunks and clamped to the board
+    const sf::Vector2f topLeft = center - viewSize / 2.f;
+    auto chunkStart = [](float pixel, int cells) {
+        int cell = std::clamp(static_cast<int>(std::floor(pixel / CELL_SIZE)) - 1, 0, cells);
+        return cell / CHUNK_CELLS * CHUNK_CELLS;
+    };
+    auto chunkEnd = [](float pixel, int cells) {
+        int cell = std::clamp(static_cast<int>(std::ceil(pixel / CELL_SIZE)) + 1, 0, cells);
+        return std::min(cells, (cell + CHUNK_CELLS - 1) / CHUNK_CELLS * CHUNK_CELLS);
+    };
+    return CellRect{chunkStart(topLeft.x, gridWidth), chunkStart(topLeft.y, gridHeight),
+                    chunkEnd(topLeft.x + viewSize.x, gridWidth), chunkEnd(topLeft.y + viewSize.y, gridHeight)};
+}
+
+void Game::drawBoard(bool withFruit) {
+    updateCamera();
+    frameTarget->setView(boardView);
+    // The grid is baked into the background layer when the camera is fixed
+    if (!boardFitsView()) drawGrid();
+    if (frame->arena) {
+        drawArena();
+    } else {
+        if (withFruit) drawFruit();
+        drawSnake();
+    }
+    flushBoard(*frameTarget);
+    frameTarget->setView(uiView);
 }
 
 void Game::drawGrid() {
-    // Draw subtle grid lines
-    sf::RectangleShape line;
-    line.setFillColor(sf::Color(40, 40, 40));
-    
-    // Vertical lines
-    for (int x = 0; x <= GRID_WIDTH; ++x) {
-        line.setSize({1, static_cast<float>(WINDOW_HEIGHT)});
-        line.setPosition({static_cast<float>(x * CELL_SIZE), 0});
-        window.draw(line);
+    PROFILE_SCOPE("drawGrid");
+    // Subtle 1px grid lines over the visible chunks
+    const sf::Color lineColor(40, 40, 40);
+    const CellRect& r = visibleCells;
+    const float left = static_cast<float>(r.x0 * CELL_SIZE);
+    const float top = static_cast<float>(r.y0 * CELL_SIZE);
+    const float width = static_cast<float>((r.x1 - r.x0) * CELL_SIZE);
+    const float height = static_cast<float>((r.y1 - r.y0) * CELL_SIZE);
+    for (int x = r.x0; x <= r.x1; ++x) {
+        appendQuad({x * CELL_SIZE + 0.5f, top + height / 2.f}, {1.f, height}, 0, TILE_WHITE, lineColor);
     }
-    
-    // Horizontal lines
-    for (int y = 0; y <= GRID_HEIGHT; ++y) {
-        line.setSize({static_cast<float>(WINDOW_WIDTH), 1});
-        line.setPosition({0, static_cast<float>(y * CELL_SIZE)});
-        window.draw(line);
+    for (int y = r.y0; y <= r.y1; ++y) {
+        appendQuad({left + width / 2.f, y * CELL_SIZE + 0.5f}, {width, 1.f}, 0, TILE_WHITE, lineColor);
     }
 }
 
 void Game::drawSnake() {
-    const auto& body = snake.getBody();
-    if (body.empty()) return;
+    PROFILE_SCOPE("drawSnake");
+    const FrameSnapshot& f = *frame;
+    if (f.length == 0) return;
 
-    sf::Vector2f headPos = gridToPixel(body[0]);
+    // Between ticks only the head and tail move: the head slides in from the
+    // previous head cell (body[1]) and the tail slides out of the cell it
+    // last vacated. Everything in between is static.
+    const float half = CELL_SIZE / 2.f;
+    const float alpha = frameAlpha;
+    const sf::Vector2f headPos = headPixel();
+    sf::Vector2f cellCenter(headPos.x + half, headPos.y + half);
     if (texturesLoaded) {
-        sf::Sprite head(headTexture);
-        // Base scale to fit cell then enlarge
-        float baseScaleX = (float)CELL_SIZE / headTexture.getSize().x * HEAD_SCALE;
-        float baseScaleY = (float)CELL_SIZE / headTexture.getSize().y * HEAD_SCALE;
-        head.setScale(sf::Vector2f(baseScaleX, baseScaleY));
-        // Use center origin so rotation works naturally
-        head.setOrigin(sf::Vector2f(headTexture.getSize().x / 2.f, headTexture.getSize().y / 2.f));
-        // Place at center of cell
-        sf::Vector2f cellCenter(headPos.x + CELL_SIZE / 2.f, headPos.y + CELL_SIZE / 2.f);
-        head.setPosition(cellCenter);
-    float rotation = 0.f; // degrees
-        // Determine direction from the first two segments (head and next). This avoids storing direction explicitly here.
-        if (body.size() > 1) {
-            Position headGrid = body[0];
-            Position nextGrid = body[1];
-            int dx = headGrid.x - nextGrid.x;
-            int dy = headGrid.y - nextGrid.y;
-            if (dx == 1 && dy == 0) rotation = 0.f;          // moving RIGHT
-            else if (dx == -1 && dy == 0) rotation = 180.f;   // moving LEFT
-            else if (dx == 0 && dy == -1) rotation = 90.f;    // moving DOWN (since texture right -> rotate 90 to face down)
-            else if (dx == 0 && dy == 1) rotation = -90.f;    // moving UP
-        }
-    head.setRotation(sf::degrees(rotation));
-        window.draw(head);
+        // Texture faces right; turn it toward the direction of travel,
+        // taken from the first two segments (head and next).
+        int quarterTurns = 0;
+        if (f.length > 1) {
+            int dx = f.head.x - f.neck.x;
+            int dy = f.head.y - f.neck.y;
+            if (dx == -1 && dy == 0) quarterTurns = 2;      // moving LEFT
+            else if (dx == 0 && dy == 1) quarterTurns = 1;  // moving DOWN
+            else if (dx == 0 && dy == -1) quarterTurns = 3; // moving UP
+        }
+        float size = CELL_SIZE * HEAD_SCALE;
+        appendQuad(cellCenter, {size, size}, quarterTurns, TILE_HEAD, sf::Color::White);
     } else {
-        sf::RectangleShape fallback({(float)CELL_SIZE - 2.f, (float)CELL_SIZE - 2.f});
-        fallback.setFillColor(sf::Color::Green);
-    fallback.setPosition(sf::Vector2f(headPos.x + 1.f, headPos.y + 1.f));
-        window.draw(fallback);
+        appendQuad(cellCenter, {CELL_SIZE - 2.f, CELL_SIZE - 2.f}, 0, TILE_WHITE, sf::Color::Green);
     }
 
-    // Body segments with gradient
-    for (size_t i = 1; i < body.size(); ++i) {
-        float t = static_cast<float>(i) / (body.size()-1);
-        sf::Vector2f p = gridToPixel(body[i]);
+    auto appendSegment = [&](sf::Vector2f p) {
+        sf::Vector2f center(p.x + half, p.y + half);
         if (texturesLoaded) {
-            sf::Sprite seg(bodyTexture);
-            seg.setPosition(p);
-            seg.setScale(sf::Vector2f((float)CELL_SIZE / bodyTexture.getSize().x, (float)CELL_SIZE / bodyTexture.getSize().y));
-            window.draw(seg);
+            appendQuad(center, {(float)CELL_SIZE, (float)CELL_SIZE}, 0, TILE_BODY, sf::Color::White);
         } else {
-            sf::RectangleShape segRect({CELL_SIZE - 3.f, CELL_SIZE - 3.f});
-            segRect.setFillColor(sf::Color(0, 180, 0));
-            segRect.setPosition(sf::Vector2f(p.x + 1.5f, p.y + 1.5f));
-            window.draw(segRect);
+            appendQuad(center, {CELL_SIZE - 3.f, CELL_SIZE - 3.f}, 0, TILE_WHITE, sf::Color(0, 180, 0));
+        }
+    };
+    if (f.length < 2) return;
+
+    // Body segments: scan the snapshot's cells of the visible rows rather
+    // than walking the body, so cost does not grow with the snake's length.
+    // The head and the interpolated tail are drawn separately.
+    const CellRect r = visibleSnapshotCells();
+    const int stride = f.cells.x1 - f.cells.x0;
+    for (int y = r.y0; y < r.y1; ++y) {
+        const std::int32_t* owners = f.owners.data() + (y - f.cells.y0) * stride - f.cells.x0;
+        for (int x = r.x0; x < r.x1; ++x) {
+            if (owners[x] == FREE_CELL) continue;
+            const Position cell(x, y);
+            if (cell == f.head || cell == f.tail) continue;
+            appendSegment(gridToPixel(cell));
         }
     }
+
+    sf::Vector2f tail = gridToPixel(f.tail);
+    if (alpha < 1.f) {
+        sf::Vector2f from = gridToPixel(f.lastTail);
+        tail = from + (tail - from) * alpha;
+    }
+    appendSegment(tail);
 }
 
 void Game::drawFruit() {
-    sf::Vector2f pixelPos = gridToPixel(fruit.getPosition());
+    PROFILE_SCOPE("drawFruit");
+    const Position& fruit = frame->fruit;
+    const CellRect& r = visibleCells;
+    if (fruit.x < r.x0 || fruit.x >= r.x1 || fruit.y < r.y0 || fruit.y >= r.y1) return;
+    sf::Vector2f pixelPos = gridToPixel(fruit);
+    sf::Vector2f center(pixelPos.x + CELL_SIZE / 2.f, pixelPos.y + CELL_SIZE / 2.f);
     if (fruitTextureLoaded) {
-        sf::Sprite fruitSprite(fruitTexture);
-    float baseScaleX = (float)CELL_SIZE / fruitTexture.getSize().x * FRUIT_SCALE;
-    float baseScaleY = (float)CELL_SIZE / fruitTexture.getSize().y * FRUIT_SCALE;
-    fruitSprite.setScale(sf::Vector2f(baseScaleX, baseScaleY));
-    fruitSprite.setOrigin(sf::Vector2f(fruitTexture.getSize().x / 2.f, fruitTexture.getSize().y / 2.f));
-    fruitSprite.setPosition(sf::Vector2f(pixelPos.x + CELL_SIZE / 2.f, pixelPos.y + CELL_SIZE / 2.f));
-        window.draw(fruitSprite);
+        float size = CELL_SIZE * FRUIT_SCALE;
+        appendQuad(center, {size, size}, 0, TILE_FRUIT, sf::Color::White);
     } else {
-        sf::CircleShape fruitShape(CELL_SIZE / 2.0f - 2);
-        fruitShape.setFillColor(sf::Color::Red);
-        fruitShape.setPosition({pixelPos.x + 2, pixelPos.y + 2});
-        window.draw(fruitShape);
+        appendQuad(center, {CELL_SIZE - 4.f, CELL_SIZE - 4.f}, 0, TILE_CIRCLE, sf::Color::Red);
     }
 }
 
-void Game::drawUI() {
-    if (scoreText) window.draw(*scoreText);
+namespace {
+const sf::Color ARENA_COLORS[] = {
+    sf::Color(0, 180, 0), sf::Color(0, 150, 220), sf::Color(230, 200, 0), sf::Color(220, 90, 200),
+    sf::Color(240, 130, 30), sf::Color(0, 200, 170), sf::Color(160, 110, 240), sf::Color(200, 200, 200),
+};
+}
+
+// Walks the ownership grid of the visible cells, so the cost follows the
+// screen however many snakes there are. Moves are not interpolated.
+void Game::drawArena() {
+    PROFILE_SCOPE("drawArena");
+    const int palette = static_cast<int>(sizeof(ARENA_COLORS) / sizeof(ARENA_COLORS[0]));
+    const FrameSnapshot& f = *frame;
+    const CellRect r = visibleSnapshotCells();
+    const int stride = f.cells.x1 - f.cells.x0;
+    for (int y = r.y0; y < r.y1; ++y) {
+        const std::int32_t* owners = f.owners.data() + (y - f.cells.y0) * stride - f.cells.x0;
+        for (int x = r.x0; x < r.x1; ++x) {
+            const sf::Vector2f pixel = gridToPixel(Position(x, y));
+            const sf::Vector2f center(pixel.x + CELL_SIZE / 2.f, pixel.y + CELL_SIZE / 2.f);
+            const std::int32_t owner = owners[x];
+            if (owner >= 0) {
+                const int id = owner >> 1;
+                const sf::Color color = ARENA_COLORS[id % palette];
+                if (owner & 1) {
+                    appendQuad(center, {CELL_SIZE - 1.f, CELL_SIZE - 1.f}, 0, TILE_CIRCLE,
+                               static_cast<std::size_t>(id) == f.follow ? sf::Color::White : color);
+                } else {
+                    appendQuad(center, {CELL_SIZE - 3.f, CELL_SIZE - 3.f}, 0, TILE_WHITE, color);
+                }
+            } else if (owner == FRUIT_CELL) {
+                if (fruitTextureLoaded) {
+                    appendQuad(center, {CELL_SIZE * FRUIT_SCALE, CELL_SIZE * FRUIT_SCALE}, 0, TILE_FRUIT, sf::Color::White);
+                } else {
+                    appendQuad(center, {CELL_SIZE - 4.f, CELL_SIZE - 4.f}, 0, TILE_CIRCLE, sf::Color::Red);
+                }
+            }
+        }
+    }
+}
+
+// Shows the labels that belong to the current state; only a change of
+// state marks the HUD layer dirty.
+void Game::syncHud() {
+    const GameState state = frame->state;
+    const bool ended = state == GameState::GAME_OVER || state == GameState::WON;
+    const int pending = assetsPending.load(std::memory_order_relaxed);
+    hud.setString(Hud::SCORE, frame->score);
+    if (pending > 0) updateLoadingText(pending);
+    hud.setVisible(Hud::MENU, state == GameState::MENU);
+    hud.setVisible(Hud::SCORE, state != GameState::MENU);
+    hud.setVisible(Hud::PAUSED, state == GameState::PAUSED);
+    hud.setVisible(Hud::GAME_OVER, state == GameState::GAME_OVER);
+    hud.setVisible(Hud::WIN, state == GameState::WON);
+    hud.setVisible(Hud::RESTART, ended);
+    hud.setVisible(Hud::LOADING, pending > 0);
 }
 
-bool Game::isValidPosition(const Position& pos) const {
-    return pos.x >= 0 && pos.x < GRID_WIDTH && pos.y >= 0 && pos.y < GRID_HEIGHT;
+void Game::drawUI() {
+    PROFILE_SCOPE("drawUI");
+    syncHud();
+    hud.draw(*frameTarget);
 }
 
 sf::Vector2f Game::gridToPixel(const Position& pos) const {
     return {static_cast<float>(pos.x * CELL_SIZE), static_cast<float>(pos.y * CELL_SIZE)};
 }
+
+#ifdef SNAKE_PROFILE
+void Game::drawProfilerOverlay() {
+    const profiler::FrameStats stats = profiler::frameStats();
+    const float graphWidth = 240.f;
+    const float graphHeight = 60.f;
+    const float msScale = graphHeight / 33.3f; // full height = two 60 Hz frames
+    const sf::Vector2f origin(WINDOW_WIDTH - graphWidth - 10.f, 40.f);
+
+    // Backdrop, a 16.7 ms guide line and one bar per frame, oldest at the left
+    profilerGraph.clear();
+    auto bar = [this](float x0, float y0, float x1, float y1, sf::Color c) {
+        profilerGraph.push_back(sf::Vertex{{x0, y0}, c, {}});
+        profilerGraph.push_back(sf::Vertex{{x1, y0}, c, {}});
+        profilerGraph.push_back(sf::Vertex{{x1, y1}, c, {}});
+        profilerGraph.push_back(sf::Vertex{{x0, y0}, c, {}});
+        profilerGraph.push_back(sf::Vertex{{x1, y1}, c, {}});
+        profilerGraph.push_back(sf::Vertex{{x0, y1}, c, {}});
+    };
+    const float bottom = origin.y + graphHeight;
+    bar(origin.x, origin.y, origin.x + graphWidth, bottom, sf::Color(0, 0, 0, 160));
+    const float barWidth = graphWidth / profiler::FRAME_HISTORY;
+    for (std::size_t i = 0; i < stats.count; ++i) {
+        float ms = stats.frameMs[i];
+        float height = std::min(graphHeight, ms * msScale);
+        sf::Color color = ms > 33.3f ? sf::Color::Red : ms > 16.7f ? sf::Color::Yellow : sf::Color::Green;
+        float x = origin.x + i * barWidth;
+        bar(x, bottom - height, x + barWidth, bottom, color);
+    }
+    float guide = bottom - 16.7f * msScale;
+    bar(origin.x, guide, origin.x + graphWidth, guide + 1.f, sf::Color(255, 255, 255, 120));
+    frameTarget->draw(profilerGraph.data(), profilerGraph.size(), sf::PrimitiveType::Triangles);
+
+    if (!profilerText) {
+        profilerText = std::make_unique<sf::Text>(loadFont(currentFontIndex), "", 14);
+        profilerText->setFillColor(sf::Color::White);
+    }
+    const AudioManager::LatencyStats& audio = frame->audio;
+    char line[192];
+    std::snprintf(line, sizeof(line), "frame p50 %.2f ms  p99 %.2f ms  max %.2f ms\n"
+                  "sfx latency p50 %.1f ms  max %.1f ms  voices %d/%d",
+                  stats.p50Ms, stats.p99Ms, stats.maxMs, audio.p50Ms, audio.maxMs, audio.busyVoices,
+                  AudioManager::VOICE_COUNT);
+    profilerText->setString(line);
+    profilerText->setPosition({origin.x, bottom + 4.f});
+    frameTarget->draw(*profilerText);
+}
+
+void Game::dumpTrace() {
+    std::string path = "trace-" + std::to_string(traceDumps++) + ".json";
+    if (profiler::writeChromeTrace(path)) {
+        std::cout << "Wrote " << path << std::endl;
+    } else {
+        std::cerr << "Warning: Could not write trace: " << path << std::endl;
+    }
+}
+#endif
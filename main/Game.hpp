@@ -4,83 +4,83 @@
 #include <SFML/Audio.hpp>
 #include <vector>
 #include <memory>
-#include <random>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+#include <functional>
 #include <string>
 
+#include "SnakeSim.hpp"
+#include "Replay.hpp"
+#include "Rewind.hpp"
+#include "Profiler.hpp"
+#include "AssetBundle.hpp"
+#include "Assets.hpp"
+#include "TaskPool.hpp"
+#include "Autopilot.hpp"
+#include "Arena.hpp"
+#include "NetClient.hpp"
+#include "FrameEncoder.hpp"
+#include "TripleBuffer.hpp"
+
 enum class GameState {
     MENU,
     PLAYING,
     PAUSED,
-    GAME_OVER
-};
-
-enum class Direction {
-    UP,
-    DOWN,
-    LEFT,
-    RIGHT
+    GAME_OVER,
+    WON         // snake fills the whole board
 };
 
-struct Position {
-    int x, y;
-    
-    Position(int x = 0, int y = 0) : x(x), y(y) {}
-    
-    bool operator==(const Position& other) const {
-        return x == other.x && y == other.y;
-    }
-    
-    Position operator+(const Position& other) const {
-        return Position(x + other.x, y + other.y);
-    }
-};
-
-class Snake {
-private:
-    std::vector<Position> body;
-    Direction direction;
-    Direction nextDirection;
-    
+class AudioManager {
 public:
-    Snake();
-    void move();
-    void grow();
-    void setDirection(Direction dir);
-    bool checkSelfCollision() const;
-    const std::vector<Position>& getBody() const { return body; }
-    const Position& getHead() const { return body.front(); }
-    void reset();
-};
+    enum Effect { EAT, GAME_OVER, MOVE, EFFECT_COUNT };
+    static const int VOICE_COUNT = 8;
 
-class Fruit {
 private:
-    Position position;
-    std::mt19937 rng;
-    std::uniform_int_distribution<int> xDist;
-    std::uniform_int_distribution<int> yDist;
-    
-public:
-    Fruit(int gridWidth, int gridHeight);
-    void respawn(const std::vector<Position>& snakeBody);
-    const Position& getPosition() const { return position; }
-};
+    // Decoded once; every voice playing an effect shares its buffer
+    std::unique_ptr<sf::SoundBuffer> buffers[EFFECT_COUNT];
+
+    // Fixed pool of voices shared by all effects, created with the first
+    // buffer. A trigger takes an idle voice or steals the least recently
+    // started one, so rapid eats and turns overlap instead of cutting each
+    // other off, and triggering never allocates or locks.
+    // Per-effect cap, so a burst of turns cannot take every voice
+    static constexpr int MAX_VOICES[EFFECT_COUNT] = { 4, 1, 3 };
+    struct Voice {
+        std::unique_ptr<sf::Sound> sound;
+        Effect effect = EFFECT_COUNT;   // whose buffer is bound
+        std::uint64_t started = 0;      // trigger serial, for LRU stealing
+#ifdef SNAKE_PROFILE
+        std::uint64_t triggeredNs = 0;  // 0 once its latency is recorded
+#endif
+    };
+    Voice voices[VOICE_COUNT];
+    std::uint64_t triggers = 0;
 
-class AudioManager {
-private:
-    sf::SoundBuffer eatBuffer;
-    sf::SoundBuffer gameOverBuffer;
-    sf::SoundBuffer moveBuffer;
-    std::unique_ptr<sf::Sound> eatSound;
-    std::unique_ptr<sf::Sound> gameOverSound;
-    std::unique_ptr<sf::Sound> moveSound;
     std::unique_ptr<sf::Music> music;
     bool soundEnabled;
     bool musicEnabled;
     static constexpr float MUSIC_VOLUME = 15.f; // percent (0-100)
+    void play(Effect effect);
+
+#ifdef SNAKE_PROFILE
+    // Trigger-to-playback latency of the last LATENCY_HISTORY triggers
+    static constexpr int LATENCY_HISTORY = 128;
+    float latencyMs[LATENCY_HISTORY] = {};
+    int latencyCount = 0;
+#endif
     
 public:
     AudioManager();
-    bool loadSounds();
+    // Decode or open an asset, from the bundle when it has it, otherwise
+    // from assets/audios. Safe to call on a worker thread; nullptr if
+    // missing.
+    static std::unique_ptr<sf::SoundBuffer> loadEffect(const AssetBundle& bundle, Effect effect);
+    static std::unique_ptr<sf::Music> openMusic(const AssetBundle& bundle);
+    // Swap a loaded asset in; main thread only
+    void setEffect(Effect effect, std::unique_ptr<sf::SoundBuffer> buffer);
+    void setMusic(std::unique_ptr<sf::Music> stream);
     void playEatSound();
     void playGameOverSound();
     void playMoveSound();
@@ -90,70 +90,415 @@ public:
     void toggleMusic();
     bool isSoundEnabled() const { return soundEnabled; }
     bool isMusicEnabled() const { return musicEnabled; }
+
+#ifdef SNAKE_PROFILE
+    struct LatencyStats {
+        float p50Ms;
+        float maxMs;
+        int samples;
+        int busyVoices;
+    };
+    // Call once per frame: records the latency of voices that started
+    // playing since the last call
+    void pollLatency();
+    LatencyStats latencyStats() const;
+#endif
+};
+
+// Retained-mode HUD. A label is laid out again only when its string or font
+// changes, and the visible labels are composited into one off-screen layer
+// that is redrawn only when something changed, so a steady frame costs one
+// sprite draw and no allocations.
+class Hud {
+public:
+    enum Label { SCORE, MENU, PAUSED, GAME_OVER, WIN, RESTART, LOADING, LABEL_COUNT };
+
+private:
+    struct Widget {
+        std::unique_ptr<sf::Text> text;
+        std::string content;    // last string set; compared before touching the text
+        sf::Vector2f anchor;
+        bool centered = false;
+        bool visible = false;
+    };
+    Widget widgets[LABEL_COUNT];
+    sf::View view;
+    sf::RenderTexture layer;
+    std::unique_ptr<sf::Sprite> layerSprite;
+    bool dirty = true;
+    void add(Label label, const sf::Font& font, const char* content, unsigned size, sf::Color color,
+             sf::Vector2f anchor, bool centered);
+    void layout(Widget& widget);
+
+public:
+    void create(const sf::Font& font, const sf::View& view);
+    // Sizes the layer to the window's pixels; call at init and on resize
+    void resize(sf::Vector2u pixelSize);
+    void setFont(const sf::Font& font);
+    void setString(Label label, const char* content);
+    void setVisible(Label label, bool visible);
+    void draw(sf::RenderTarget& target);
 };
 
 class Game {
+    friend struct RenderBench; // bench.cpp times drawGrid/drawSnake off screen
 private:
+    // Declared first: startupClock also times window creation, and the
+    // bundle's mapping must outlive the fonts and music streamed from it
+    sf::Clock startupClock;
+    bool firstFrameLogged = false;
+    AssetBundle bundle;
     sf::RenderWindow window;
-    sf::Font font;
-    std::unique_ptr<sf::Text> scoreText;
-    std::unique_ptr<sf::Text> gameOverText;
-    std::unique_ptr<sf::Text> menuText;
-    std::unique_ptr<sf::Text> pauseText;
+    Hud hud;
     
-    Snake snake;
-    Fruit fruit;
+    SnakeSim sim;
     AudioManager audioManager;
     
     GameState gameState;
-    int score;
-    float gameSpeed;
-    sf::Clock gameClock;
-    sf::Time lastUpdate;
-    std::vector<Position> prevSnakeBody; // for interpolation
+    // Fixed-timestep loop: frame time feeds an accumulator that is drained
+    // in whole ticks of sim.getGameSpeed() ms. renderAlpha is the fraction
+    // of the next tick already elapsed, used to interpolate the head and tail.
+    sf::Clock frameClock;
+    sf::Time tickAccumulator;
+    float renderAlpha = 1.f;
+    bool quitRequested = false;
+
+    // Threads. The main thread polls input, ticks the game and, after each
+    // update, publishes a FrameSnapshot through a lock-free triple buffer;
+    // it then sleeps for at most INPUT_POLL_INTERVAL, so input and ticks
+    // never wait behind a frame. The render thread owns the window's GL
+    // context and everything drawn (atlas, layers, HUD, fonts) and draws the
+    // newest snapshot each frame, at the display's pace. A capture renders
+    // on the main thread instead, in lock-step with the game.
+    struct CellRect { int x0, y0, x1, y1; }; // half-open cell range
+    struct FrameSnapshot {
+        GameState state = GameState::MENU;
+        bool turbo = false;
+        bool arena = false;
+        // Interpolation alpha when published, and its change per second of
+        // sharedClock time (negative while rewinding)
+        sf::Time published;
+        float alpha = 1.f;
+        float alphaRate = 0.f;
+        // The followed snake: in arena mode only the head means anything
+        std::size_t length = 0;
+        Position head, neck, tail, lastTail;
+        Position fruit;
+        std::size_t follow = 0;
+        // What is in each cell any camera between neck and head can see,
+        // row by row: FREE_CELL, FRUIT_CELL (arena only) or snake id << 1,
+        // with the low bit set on an arena snake's head
+        CellRect cells{0, 0, 0, 0};
+        std::vector<std::int32_t> owners;
+        char score[96] = {};
+        sf::Vector2u windowSize;
+        int fontIndex = 0;
+#ifdef SNAKE_PROFILE
+        bool profilerOverlay = false;
+        AudioManager::LatencyStats audio{};
+#endif
+    };
+    static constexpr std::int32_t FREE_CELL = -1;
+    static constexpr std::int32_t FRUIT_CELL = -2;
+    TripleBuffer<FrameSnapshot> snapshots;
+    sf::Clock sharedClock;              // read by both threads
+    std::thread renderThread;
+    std::atomic<bool> renderStop{false};
+    char scoreText[96] = {};            // main thread; updateScore() writes it
+    sf::Vector2u windowSize;            // main thread's view of the window
+    int selectedFont = 0;               // main thread; F cycles it
+    void publishFrame();
+    void fillSnapshot(FrameSnapshot& out) const;
+    void renderLoop();
+    void stopRenderThread();
+
+    // Render on change. A snapshot is published only when its FrameKey
+    // differs from the last one; between ticks the render thread
+    // extrapolates alpha itself. The render thread draws a frame for a new
+    // snapshot, while alpha is still moving, or when woken (an asset
+    // arrived), and otherwise sleeps on renderWake. In MENU, PAUSED and the
+    // end screens the main thread blocks in waitEvent() instead of polling,
+    // so an idle game does almost nothing until a key is pressed.
+    struct FrameKey {
+        GameState state;
+        bool turbo;
+        bool rewinding;
+        bool profilerOverlay;
+        std::uint64_t game;             // seed, or the online game's id
+        std::uint64_t ticks;
+        std::size_t follow;
+        std::uint32_t redraws;          // bumped when the window needs a fresh frame
+        int fontIndex;
+        sf::Vector2u windowSize;
+        char score[96];
+        bool operator==(const FrameKey& other) const;
+    };
+    FrameKey publishedKey{};
+    bool keyPublished = false;
+    std::uint32_t redraws = 0;
+    std::mutex renderMutex;
+    std::condition_variable renderWake;
+    bool renderRequested = false;       // guarded by renderMutex
+    FrameKey frameKey() const;
+    void wakeRenderer();
+    void waitForInput();
+
+    // CPU, frames and wake-ups per game state, kept by each thread for
+    // itself and logged at exit. GPU time cannot be read through SFML;
+    // frames per second stands in for it, as each frame is a full redraw.
+    static const int STATE_COUNT = static_cast<int>(GameState::WON) + 1;
+    struct UsageMeter {
+        struct Entry {
+            double wallSeconds = 0.0;
+            double cpuSeconds = 0.0;
+            std::uint64_t frames = 0;
+            std::uint64_t wakeups = 0;
+        };
+        Entry states[STATE_COUNT];
+        sf::Clock wall;
+        double lastCpu = 0.0;
+        // Call on the metered thread before the first charge()
+        void start();
+        // Charges the time since the last call to state
+        void charge(GameState state, bool drewFrame, bool wokeUp);
+    };
+    UsageMeter mainUsage;
+    UsageMeter renderUsage;             // render thread; read once it has joined
+    void logUsage() const;
+
+    // Render thread only: the snapshot being drawn and its alpha now
+    const FrameSnapshot* frame = nullptr;
+    float frameAlpha = 1.f;
+    sf::Vector2u layerSize;             // window pixels the layers were sized for
+
+    // Every session is recorded to replays/; with --replay a recorded
+    // session drives the sim instead of the keyboard. Turbo mode runs
+    // thousands of ticks per frame and only redraws a few times a second.
+    ReplayRecorder recorder;
+    ReplayReader replayReader;
+    std::unique_ptr<ReplayPlayer> replayPlayer;
+    bool turbo = false;
+
+    // Rewind (hold R in a local game): each tick leaves an undo record in a
+    // fixed ring of REWIND_TICKS, and while R is held the game runs
+    // backwards through it at REWIND_RATE times its speed, interpolated as
+    // in forward play. Letting go plays on from there, and the recording
+    // drops the ticks taken back.
+    RewindBuffer rewind{REWIND_TICKS};
+    bool rewinding = false;
+    void startRewind();
+    void stepRewind(sf::Time frameTime);
+    void stopRewind();
+
+    // Autopilot (A, or --autopilot for kiosks and soak tests). Each move is
+    // planned on the worker's thread during the tick before it; a tick whose
+    // move is not ready plays a safe move instead of waiting. While it is on,
+    // a new game starts AUTOPILOT_RESTART_DELAY seconds after one ends, and
+    // any arrow key hands control back to the player.
+    std::unique_ptr<AutopilotWorker> autopilot;
+    std::uint64_t autopilotLateTicks = 0;
+    sf::Clock gameEndClock;
+    void steerAutopilot();
+    void logAutopilotStats();
+
+    // Arena spectator mode (--arena N): many bot snakes share the board and
+    // the player only watches. The camera follows one living snake and
+    // moves on to the next id when it dies.
+    std::unique_ptr<Arena> arena;
+    std::size_t arenaFollow = 0;
+    void followLiveSnake();
+    // The followed snake, or nullptr when it is dead
+    const ArenaSnake* followedSnake() const;
+    void drawArena();
+
+    // Capture (--capture): each frame is drawn into the next of a ring of
+    // CAPTURE_TEXTURES render textures and shown from there. A texture is
+    // read back only CAPTURE_TEXTURES - 1 frames after it was drawn, so the
+    // GPU has long finished it and the copy does not stall, and handed to
+    // the encoder's thread; a full encoder queue holds the loop back rather
+    // than dropping frames. Each frame advances the game by exactly
+    // 1/captureFps, so the clip has every tick whatever a frame really took.
+    static const std::size_t CAPTURE_TEXTURES = 3;
+    sf::RenderTarget* frameTarget = nullptr;    // window, or this frame's capture texture
+    std::unique_ptr<FrameEncoder> encoder;
+    sf::RenderTexture captureTextures[CAPTURE_TEXTURES];
+    unsigned captureFps = 60;
+    std::uint64_t captureFrames = 0;            // drawn
+    std::uint64_t captureRead = 0;              // read back and submitted
+    std::uint64_t captureStopFrame = 0;         // 0 until the first game ends
+    sf::Time captureReadTime;                   // main thread: readback and submit
+    sf::Time captureReadMax;
+    void presentCapture();
+    void readBackCapture(std::uint64_t frame);
+    void finishCapture();
+
+    // Online play (--connect): snake_server runs the game and sim is the
+    // client's prediction of it, stepped and reconciled by netClient.
+    std::unique_ptr<NetClient> netClient;
+    std::uint32_t netGame = ~0u;
+    std::uint64_t netMispredictions = 0;    // reconciliations already drawn
+    void pollNetwork();
 
     // Textures & sprites
     sf::Texture bgTexture;
-    sf::Texture headTexture;
-    sf::Texture bodyTexture;
-    sf::Texture fruitTexture;
     std::unique_ptr<sf::Sprite> backgroundSprite;
-    bool texturesLoaded = false;
+    bool texturesLoaded = false;        // background, head and body
     bool fruitTextureLoaded = false;
 
-    // Font management
+    // Board sprites are packed into one atlas at load time and the grid,
+    // fruit and snake are emitted as textured triangles into one reused
+    // vertex buffer, submitted with a single draw call per frame.
+    enum AtlasTile { TILE_HEAD, TILE_BODY, TILE_FRUIT, TILE_CIRCLE, TILE_WHITE, TILE_COUNT };
+    static const int ATLAS_TILE = assets::TILE_SIZE;   // tile edge in pixels
+    static const int ATLAS_STRIDE = ATLAS_TILE + 2;    // 1px gutter against filtering bleed
+    sf::Texture atlasTexture;
+    std::vector<sf::Vertex> boardVertices;
+    bool tileLoaded[TILE_COUNT] = {};
+    bool backgroundLoaded = false;
+    static sf::Vector2u tileOrigin(AtlasTile tile);
+    bool buildAtlas();
+    bool loadImage(const char* bundleName, const std::string& path, sf::Image& image) const;
+    void appendQuad(sf::Vector2f center, sf::Vector2f size, int quarterTurns, AtlasTile tile, sf::Color color);
+
+    // Background image and grid pre-composited off-screen; blitted with one
+    // draw per frame. Rebuilt at init and when the window size changes.
+    sf::RenderTexture backgroundLayer;
+    std::unique_ptr<sf::Sprite> backgroundLayerSprite;
+    void rebuildBackgroundLayer();
+
+#ifdef SNAKE_PROFILE
+    // F3 toggles a frame-time graph with p50/p99; F4 writes a Chrome trace
+    bool profilerOverlay = false;
+    int traceDumps = 0;
+    std::unique_ptr<sf::Text> profilerText;
+    std::vector<sf::Vertex> profilerGraph;
+    void drawProfilerOverlay();
+    void dumpTrace();
+#endif
+
+    // Font management. Every font is read fully into memory once (or used
+    // in place from the bundle) and kept, so cycling with F never touches
+    // the disk.
+    struct LoadedFont {
+        std::vector<char> bytes;    // empty when the bundle mapping backs the font
+        sf::Font font;
+    };
     std::vector<std::string> fontPaths;
+    std::vector<std::shared_ptr<LoadedFont>> fontCache;  // parallel to fontPaths
     int currentFontIndex = 0;
+    std::shared_ptr<LoadedFont> openFont(const std::string& path) const;
+    const sf::Font& loadFont(int index);
     void applyFont();
+
+    // Background asset loading. Jobs decode on loaderPool and post an apply
+    // step. Textures and fonts are swapped in by the render thread in
+    // pollLoadedAssets(), sounds by the main thread in pollLoadedAudio().
+    // The MENU shows a loading line until every asset has arrived.
+    std::mutex loadedMutex;
+    std::vector<std::function<void()>> loadedAssets;
+    std::vector<std::function<void()>> loadedAudio;
+    int assetsTotal = 0;
+    std::atomic<int> assetsPending{0};
+    static const unsigned LOADER_THREADS = 4;
+    void loadAssetsAsync();
+    void postLoaded(std::function<void()> apply);
+    void postLoadedAudio(std::function<void()> apply);
+    void pollLoadedAssets();
+    void pollLoadedAudio();
+    void applyLoaded(std::vector<std::function<void()>>& queue);
+    // Blocks until every asset has loaded and applies them on this thread;
+    // for callers without a render thread, such as the render bench
+    void finishLoadingAssets();
+    void applyBackground();
+    void updateLoadingText(int pending);
     
-    // Grid settings
-    static const int GRID_WIDTH = 40;
-    static const int GRID_HEIGHT = 30;
+    // Grid settings. The board size is chosen at run time; the window is a
+    // fixed-size camera onto it.
+    int gridWidth;
+    int gridHeight;
     static const int CELL_SIZE = 20;
-    static const int WINDOW_WIDTH = GRID_WIDTH * CELL_SIZE;
-    static const int WINDOW_HEIGHT = GRID_HEIGHT * CELL_SIZE;
+    static const int WINDOW_WIDTH = SnakeSim::DEFAULT_GRID_WIDTH * CELL_SIZE;
+    static const int WINDOW_HEIGHT = SnakeSim::DEFAULT_GRID_HEIGHT * CELL_SIZE;
+
+    // Camera. boardView follows the head, clamped to the board edges, and
+    // stays centred when the board fits the window. The board is drawn in
+    // CHUNK_CELLS-square chunks and only chunks overlapping the view are
+    // processed, so frame cost tracks the screen rather than the board area
+    // or snake length.
+    static const int CHUNK_CELLS = 16;
+    sf::View uiView;
+    sf::View boardView;
+    CellRect visibleCells{0, 0, 0, 0};  // visible chunks, clamped to the board
+    void updateCamera();
+    void aimCamera(sf::Vector2f center);
+    sf::Vector2f cameraCenter(sf::Vector2f head) const;
+    CellRect cellsUnder(sf::Vector2f center) const;
+    CellRect visibleSnapshotCells() const;
+    bool boardFitsView() const;
+    sf::Vector2f headPixel() const;
     
     // Game settings
-    static constexpr float BASE_SPEED = 150.0f; // milliseconds per move
-    static constexpr float SPEED_INCREASE = 5.0f;
     static constexpr float HEAD_SCALE = 1.4f; // enlarge head sprite for visibility (1.0 = fit cell)
     static constexpr float FRUIT_SCALE = 1.4f; // enlarge fruit sprite
+    static constexpr float MAX_FRAME_TIME = 0.25f; // seconds of backlog caught up after a stall
+    static const unsigned MAX_FRAME_RATE = 240;
+    static const int TURBO_TICKS_PER_FRAME = 4096;
+    static constexpr float TURBO_RENDER_INTERVAL = 0.25f; // seconds between redraws in turbo
+    static const std::int64_t REPLAY_SEEK_TICKS = 100;
+    static const std::size_t REWIND_TICKS = 512;          // 25 s at top speed
+    static constexpr float REWIND_RATE = 2.f;
+    static constexpr float AUTOPILOT_BUDGET_MS = 5.f;      // planning time per tick
+    static constexpr float AUTOPILOT_RESTART_DELAY = 3.f;  // seconds
+    static const std::size_t CAPTURE_QUEUE_FRAMES = 8;
+    static constexpr float INPUT_POLL_INTERVAL = 0.001f;   // seconds the main thread sleeps at most
+    static constexpr float CAPTURE_TAIL = 1.f;              // seconds recorded after the game ends
+
+    // Declared last so it is destroyed first: workers are joined while
+    // everything their jobs touch is still alive
+    TaskPool loaderPool{LOADER_THREADS};
     
 public:
-    Game();
+    static constexpr int MIN_BOARD_SIDE = 8;
+    static constexpr int MAX_BOARD_SIDE = 4096;
+    static bool isValidBoardSize(int width, int height);
+
+    Game(int gridWidth = SnakeSim::DEFAULT_GRID_WIDTH, int gridHeight = SnakeSim::DEFAULT_GRID_HEIGHT);
     bool initialize();
+    // Plays back a recorded session instead of taking keyboard input
+    bool loadReplay(const std::string& path, bool turboMode);
+    // Has no effect while a replay is playing
+    void setAutopilot(bool enabled);
+    // Replaces the player's game with an arena of snakeCount bots stepped
+    // on threads threads (including the main thread)
+    void setArena(std::size_t snakeCount, unsigned threads);
+    // Plays on a snake_server at address ("host:port") instead of locally
+    bool connect(const std::string& address);
+    // Records every frame to path at fps frames per second of game time
+    // (see FrameEncoder.hpp) and quits shortly after the first game ends
+    bool startCapture(const std::string& path, unsigned fps);
     void run();
     
 private:
     void handleEvents();
+    void handleEvent(const sf::Event& event);
     void update();
-    void render();
+    void render(const FrameSnapshot& snapshot);
     void resetGame();
+    sf::Time tickDuration() const;
+    bool advanceTick();
+    void finishRecording();
+    void seekReplay(std::int64_t deltaTicks);
+    void playerTurn(Direction dir);
     void updateScore();
+    void logInputStats() const;
+    // drawGrid/drawFruit/drawSnake append to boardVertices; flushBoard() draws them
+    void drawBackground();
+    void drawBoard(bool withFruit);
     void drawGrid();
     void drawSnake();
     void drawFruit();
+    void flushBoard(sf::RenderTarget& target);
     void drawUI();
-    bool isValidPosition(const Position& pos) const;
+    void syncHud();
     sf::Vector2f gridToPixel(const Position& pos) const;
 };
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Read-only file contents, memory-mapped where the platform allows it.
+class MappedFile {
+private:
+    const std::uint8_t* bytes = nullptr;
+    size_t length = 0;
+    bool mapped = false;
+    std::vector<std::uint8_t> fallback;
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+    bool open(const std::string& path);
+    void close();
+    const std::uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+};
@@ -0,0 +1,178 @@
+#include "NetClient.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+const auto HELLO_INTERVAL = std::chrono::milliseconds(250);
+// Keeps the session alive while there is nothing else to send
+const auto HEARTBEAT_INTERVAL = std::chrono::seconds(1);
+}
+
+// NetClient Implementation
+NetClient::NetClient(SnakeSim& sim) : sim(sim), confirmed(sim) {}
+
+bool NetClient::connect(const NetAddress& address, int width, int height) {
+    if (!socket.open()) return false;
+    server = address;
+    requestedWidth = width;
+    requestedHeight = height;
+    ready = false;
+    session = 0;
+    cookie = 0;
+    sendHello();
+    return true;
+}
+
+void NetClient::sendHello() {
+    net::Hello hello;
+    hello.width = requestedWidth;
+    hello.height = requestedHeight;
+    hello.cookie = cookie;
+    send(encode(hello, packet));
+    lastHello = Clock::now();
+}
+
+void NetClient::disconnect() {
+    if (!socket.isOpen()) return;
+    if (ready) {
+        net::SessionMessage bye;
+        bye.session = session;
+        send(encode(net::BYE, bye, packet));
+    }
+    socket.close();
+    ready = false;
+}
+
+void NetClient::receive() {
+    if (!socket.isOpen()) return;
+    NetAddress from;
+    for (long n; (n = socket.receive(packet, sizeof(packet), from)) >= 0;) {
+        if (from != server) continue;
+        ++stats.packetsIn;
+        stats.bytesIn += static_cast<std::uint64_t>(n);
+        handle(packet, static_cast<std::size_t>(n));
+    }
+    const Clock::time_point now = Clock::now();
+    if (!ready && now - lastHello >= HELLO_INTERVAL) {
+        sendHello();
+    } else if (ready && now - lastSent >= HEARTBEAT_INTERVAL) {
+        sendInput();
+    }
+}
+
+void NetClient::handle(const std::uint8_t* data, std::size_t size) {
+    if (size == 0) return;
+    if (data[0] == net::COOKIE) {
+        // The server wants its cookie back before it sets up a game
+        net::Cookie msg;
+        if (ready || !decode(data, size, msg)) return;
+        cookie = msg.cookie;
+        sendHello();
+    } else if (data[0] == net::WELCOME) {
+        net::Welcome welcome;
+        if (!decode(data, size, welcome) || (ready && welcome.session == session && welcome.game == game)) return;
+        session = welcome.session;
+        game = welcome.game;
+        sim = SnakeSim(welcome.width, welcome.height, welcome.seed);
+        confirmed = sim;
+        pending.clear();
+        predicted.clear();
+        ready = true;
+    } else if (data[0] == net::SNAPSHOT) {
+        if (!ready || !decode(data, size, snapshot) || snapshot.session != session || snapshot.game != game) return;
+        applySnapshot();
+    }
+}
+
+void NetClient::applySnapshot() {
+    ++stats.snapshots;
+    const std::uint64_t have = confirmed.getTicks();
+    // Built on a tick we never applied; a later one will be built on our ack
+    if (snapshot.baseTick > have) return;
+    bool mispredicted = false;
+    for (std::uint64_t i = have - snapshot.baseTick; i < snapshot.moveCount; ++i) {
+        const std::uint8_t dir = snapshot.moves[i];
+        confirmed.step(static_cast<Direction>(dir));
+        if (predicted.empty()) {
+            // The server got ahead of the prediction
+            mispredicted = true;
+        } else {
+            mispredicted = mispredicted || predicted.front() != dir;
+            predicted.pop_front();
+        }
+    }
+    if (snapshot.outcome & net::SNAPSHOT_CURRENT) {
+        const Position& fruit = confirmed.getFruit().getPosition();
+        const bool over = (snapshot.outcome & ~net::SNAPSHOT_CURRENT) != 0;
+        if (confirmed.getScore() != snapshot.score || confirmed.getSnake().getLength() != snapshot.length ||
+            fruit.y * confirmed.getGridWidth() + fruit.x != snapshot.fruitCell || confirmed.isOver() != over) {
+            if (stats.desyncs++ == 0) {
+                std::cerr << "Warning: game " << game << " out of sync with the server at tick " << confirmed.getTicks() << std::endl;
+            }
+        }
+    }
+    pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                 [&](const net::Turn& t) { return t.tick <= confirmed.getTicks(); }),
+                  pending.end());
+    if (mispredicted) reconcile();
+    // Acknowledge at once, so the next delta starts from here
+    if (confirmed.getTicks() != have) sendInput();
+}
+
+// Restarts the prediction from the confirmed game and replays the turns the
+// server has not confirmed, up to the tick the prediction had reached
+void NetClient::reconcile() {
+    const std::uint64_t target = sim.getTicks();
+    sim = confirmed;
+    predicted.clear();
+    std::size_t next = 0;
+    while (sim.getTicks() < target && !sim.isOver()) {
+        while (next < pending.size() && pending[next].tick <= sim.getTicks() + 1) sim.setDirection(pending[next++].dir);
+        sim.step();
+        predicted.push_back(static_cast<std::uint8_t>(sim.getSnake().getDirection()));
+        ++stats.replayedTicks;
+    }
+    ++stats.mispredictions;
+}
+
+bool NetClient::canStep() const {
+    return ready && !sim.isOver() && sim.getTicks() - confirmed.getTicks() < MAX_PREDICTED_TICKS;
+}
+
+StepResult NetClient::step() {
+    const Direction before = sim.getSnake().getDirection();
+    const StepResult result = sim.step();
+    const Direction after = sim.getSnake().getDirection();
+    if (after != before) pending.push_back(net::Turn{sim.getTicks(), after});
+    predicted.push_back(static_cast<std::uint8_t>(after));
+    // Unconfirmed turns go out every tick until a snapshot covers them, and
+    // so does every tick until the server's clock has started
+    if (!pending.empty() || confirmed.getTicks() == 0) sendInput();
+    return result;
+}
+
+void NetClient::restart() {
+    if (!ready) return;
+    net::SessionMessage msg;
+    msg.session = session;
+    send(encode(net::RESTART, msg, packet));
+}
+
+void NetClient::sendInput() {
+    net::Input input;
+    input.session = session;
+    input.game = game;
+    input.ackTick = confirmed.getTicks();
+    input.clientTick = sim.getTicks();
+    // The newest turns; older ones went out in earlier packets
+    const std::size_t first = pending.size() > net::MAX_TURNS ? pending.size() - net::MAX_TURNS : 0;
+    for (std::size_t i = first; i < pending.size(); ++i) input.turns[input.turnCount++] = pending[i];
+    send(encode(input, packet));
+}
+
+void NetClient::send(std::size_t size) {
+    if (!socket.sendTo(server, packet, size)) return;
+    lastSent = Clock::now();
+    ++stats.packetsOut;
+    stats.bytesOut += size;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+// Client side of a server-hosted game, with prediction. The caller's
+// SnakeSim is the predicted game: step() advances it at once with the
+// player's turns, as in a local game, and sends any turn to the server
+// tagged with its tick (resent each tick until confirmed). A second,
+// confirmed copy only ever applies the server's snapshot deltas, each
+// acknowledged straight away. When the server moved differently from the
+// prediction (a turn arrived late, or a packet was lost), the predicted
+// game is reset to the confirmed one and the turns the server has not
+// confirmed yet are replayed on top, like ReplayPlayer seeking from a
+// keyframe.
+
+#include "SnakeSim.hpp"
+#include "NetProtocol.hpp"
+#include "NetSocket.hpp"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class NetClient {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        std::uint64_t packetsIn = 0;
+        std::uint64_t packetsOut = 0;
+        std::uint64_t bytesIn = 0;
+        std::uint64_t bytesOut = 0;
+        std::uint64_t snapshots = 0;
+        std::uint64_t mispredictions = 0;   // reconciliations
+        std::uint64_t replayedTicks = 0;    // re-simulated by them
+        std::uint64_t desyncs = 0;          // confirmed state disagreed with the server's summary
+    };
+
+    // Furthest the prediction may run ahead of the last confirmed tick
+    static const std::uint64_t MAX_PREDICTED_TICKS = 32;
+
+private:
+    SnakeSim& sim;
+    SnakeSim confirmed;
+    UdpSocket socket;
+    NetAddress server;
+    int requestedWidth = 0;
+    int requestedHeight = 0;
+    std::uint64_t cookie = 0;           // the server's, echoed in HELLO
+    bool ready = false;                 // a WELCOME has arrived
+    std::uint32_t session = 0;
+    std::uint32_t game = 0;
+    std::vector<net::Turn> pending;     // turns made here that the server has not confirmed
+    std::deque<std::uint8_t> predicted; // direction of ticks confirmed + 1 ... sim
+    Clock::time_point lastHello;
+    Clock::time_point lastSent;
+    Stats stats;
+    std::uint8_t packet[net::MAX_PACKET];
+    net::Snapshot snapshot;             // scratch; large
+
+    void handle(const std::uint8_t* data, std::size_t size);
+    void sendHello();
+    void applySnapshot();
+    void reconcile();
+    void sendInput();
+    void send(std::size_t size);
+
+public:
+    explicit NetClient(SnakeSim& sim);
+    ~NetClient() { disconnect(); }
+    NetClient(const NetClient&) = delete;
+    NetClient& operator=(const NetClient&) = delete;
+
+    // Asks server for a game on a width x height board
+    bool connect(const NetAddress& server, int width, int height);
+    // Says BYE; safe to call twice
+    void disconnect();
+    // Handles waiting datagrams and resends HELLO until answered. May
+    // replace the predicted game (new game, or reconciliation).
+    void receive();
+    // Blocks until a datagram is waiting or timeoutMs passes
+    void wait(int timeoutMs) { socket.wait(timeoutMs); }
+    // Whether step() may run: a game is going and the prediction is not
+    // too far ahead of the server
+    bool canStep() const;
+    StepResult step();
+    // Asks for a new game; it starts when the WELCOME arrives
+    void restart();
+
+    bool isReady() const { return ready; }
+    // Changes each time a new game arrives
+    std::uint32_t getGame() const { return game; }
+    std::uint64_t getConfirmedTick() const { return confirmed.getTicks(); }
+    const Stats& getStats() const { return stats; }
+    // Test hook: drops this fraction of the datagrams sent to the server
+    void simulateLoss(double fraction, std::uint64_t seed) { socket.simulateLoss(fraction, seed); }
+};
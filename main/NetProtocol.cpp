@@ -0,0 +1,213 @@
+#include "NetProtocol.hpp"
+
+namespace net {
+namespace {
+
+class Writer {
+private:
+    std::uint8_t* out;
+    std::size_t pos = 0;
+
+public:
+    explicit Writer(std::uint8_t* out) : out(out) {}
+    std::size_t size() const { return pos; }
+    void byte(std::uint8_t v) { out[pos++] = v; }
+    void varint(std::uint64_t v) {
+        while (v >= 0x80) {
+            out[pos++] = static_cast<std::uint8_t>(v) | 0x80;
+            v >>= 7;
+        }
+        out[pos++] = static_cast<std::uint8_t>(v);
+    }
+    void fixed64(std::uint64_t v) {
+        for (int i = 0; i < 8; ++i) out[pos++] = static_cast<std::uint8_t>(v >> (8 * i));
+    }
+};
+
+// Reads past the end or overlong varints clear ok; callers check it once
+class Reader {
+private:
+    const std::uint8_t* data;
+    std::size_t size;
+    std::size_t pos = 0;
+
+public:
+    bool ok = true;
+    Reader(const std::uint8_t* data, std::size_t size) : data(data), size(size) {}
+    std::size_t remaining() const { return size - pos; }
+    std::uint8_t byte() {
+        if (pos >= size) { ok = false; return 0; }
+        return data[pos++];
+    }
+    std::uint64_t varint() {
+        std::uint64_t v = 0;
+        for (int shift = 0; shift < 64 && pos < size; shift += 7) {
+            std::uint8_t b = data[pos++];
+            v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        ok = false;
+        return 0;
+    }
+    std::uint64_t fixed64() {
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) v |= static_cast<std::uint64_t>(byte()) << (8 * i);
+        return v;
+    }
+    bool expect(MessageType type) { return byte() == type && ok; }
+};
+
+bool validSide(std::uint64_t side) {
+    return side > 0 && side <= 0xFFFF;
+}
+
+} // namespace
+
+std::size_t encode(const Hello& msg, std::uint8_t* out) {
+    Writer w(out);
+    w.byte(HELLO);
+    w.byte(PROTOCOL_VERSION);
+    w.varint(static_cast<std::uint64_t>(msg.width));
+    w.varint(static_cast<std::uint64_t>(msg.height));
+    w.fixed64(msg.cookie);
+    return w.size();
+}
+
+std::size_t encode(const Cookie& msg, std::uint8_t* out) {
+    Writer w(out);
+    w.byte(COOKIE);
+    w.fixed64(msg.cookie);
+    return w.size();
+}
+
+std::size_t encode(const Welcome& msg, std::uint8_t* out) {
+    Writer w(out);
+    w.byte(WELCOME);
+    w.varint(msg.session);
+    w.varint(msg.game);
+    w.varint(static_cast<std::uint64_t>(msg.width));
+    w.varint(static_cast<std::uint64_t>(msg.height));
+    w.fixed64(msg.seed);
+    return w.size();
+}
+
+std::size_t encode(const Input& msg, std::uint8_t* out) {
+    Writer w(out);
+    w.byte(INPUT);
+    w.varint(msg.session);
+    w.varint(msg.game);
+    w.varint(msg.ackTick);
+    w.varint(msg.clientTick);
+    w.varint(msg.turnCount);
+    for (std::size_t i = 0; i < msg.turnCount; ++i) {
+        w.varint((msg.turns[i].tick << 2) | static_cast<std::uint64_t>(msg.turns[i].dir));
+    }
+    return w.size();
+}
+
+std::size_t encode(const Snapshot& msg, const std::uint8_t* moves, std::uint8_t* out) {
+    Writer w(out);
+    w.byte(SNAPSHOT);
+    w.varint(msg.session);
+    w.varint(msg.game);
+    w.varint(msg.baseTick);
+    w.varint(msg.moveCount);
+    for (std::uint32_t i = 0; i < msg.moveCount; i += 4) {
+        std::uint8_t packed = 0;
+        for (std::uint32_t j = 0; j < 4 && i + j < msg.moveCount; ++j) packed |= (moves[i + j] & 3) << (2 * j);
+        w.byte(packed);
+    }
+    w.varint(static_cast<std::uint64_t>(msg.score));
+    w.varint(msg.length);
+    w.varint(static_cast<std::uint64_t>(msg.fruitCell));
+    w.byte(msg.outcome);
+    return w.size();
+}
+
+std::size_t encode(MessageType type, const SessionMessage& msg, std::uint8_t* out) {
+    Writer w(out);
+    w.byte(type);
+    w.varint(msg.session);
+    return w.size();
+}
+
+bool decode(const std::uint8_t* data, std::size_t size, Hello& msg) {
+    Reader r(data, size);
+    if (!r.expect(HELLO) || r.byte() != PROTOCOL_VERSION) return false;
+    const std::uint64_t width = r.varint();
+    const std::uint64_t height = r.varint();
+    msg.cookie = r.fixed64();
+    if (!r.ok || !validSide(width) || !validSide(height)) return false;
+    msg.width = static_cast<int>(width);
+    msg.height = static_cast<int>(height);
+    return true;
+}
+
+bool decode(const std::uint8_t* data, std::size_t size, Cookie& msg) {
+    Reader r(data, size);
+    if (!r.expect(COOKIE)) return false;
+    msg.cookie = r.fixed64();
+    return r.ok;
+}
+
+bool decode(const std::uint8_t* data, std::size_t size, Welcome& msg) {
+    Reader r(data, size);
+    if (!r.expect(WELCOME)) return false;
+    msg.session = static_cast<std::uint32_t>(r.varint());
+    msg.game = static_cast<std::uint32_t>(r.varint());
+    const std::uint64_t width = r.varint();
+    const std::uint64_t height = r.varint();
+    msg.seed = r.fixed64();
+    if (!r.ok || !validSide(width) || !validSide(height)) return false;
+    msg.width = static_cast<int>(width);
+    msg.height = static_cast<int>(height);
+    return true;
+}
+
+bool decode(const std::uint8_t* data, std::size_t size, Input& msg) {
+    Reader r(data, size);
+    if (!r.expect(INPUT)) return false;
+    msg.session = static_cast<std::uint32_t>(r.varint());
+    msg.game = static_cast<std::uint32_t>(r.varint());
+    msg.ackTick = r.varint();
+    msg.clientTick = r.varint();
+    const std::uint64_t count = r.varint();
+    if (!r.ok || count > MAX_TURNS) return false;
+    msg.turnCount = static_cast<std::size_t>(count);
+    for (std::size_t i = 0; i < msg.turnCount; ++i) {
+        const std::uint64_t v = r.varint();
+        msg.turns[i].tick = v >> 2;
+        msg.turns[i].dir = static_cast<Direction>(v & 3);
+    }
+    return r.ok;
+}
+
+bool decode(const std::uint8_t* data, std::size_t size, Snapshot& msg) {
+    Reader r(data, size);
+    if (!r.expect(SNAPSHOT)) return false;
+    msg.session = static_cast<std::uint32_t>(r.varint());
+    msg.game = static_cast<std::uint32_t>(r.varint());
+    msg.baseTick = r.varint();
+    const std::uint64_t count = r.varint();
+    if (!r.ok || count > MAX_DELTA_TICKS || r.remaining() < (count + 3) / 4) return false;
+    msg.moveCount = static_cast<std::uint32_t>(count);
+    for (std::uint32_t i = 0; i < msg.moveCount; i += 4) {
+        const std::uint8_t packed = r.byte();
+        for (std::uint32_t j = 0; j < 4 && i + j < msg.moveCount; ++j) msg.moves[i + j] = (packed >> (2 * j)) & 3;
+    }
+    msg.score = static_cast<int>(r.varint());
+    msg.length = static_cast<std::uint32_t>(r.varint());
+    msg.fruitCell = static_cast<std::int32_t>(r.varint());
+    msg.outcome = r.byte();
+    return r.ok;
+}
+
+bool decode(const std::uint8_t* data, std::size_t size, SessionMessage& msg) {
+    Reader r(data, size);
+    const std::uint8_t type = r.byte();
+    if (type != RESTART && type != BYE) return false;
+    msg.session = static_cast<std::uint32_t>(r.varint());
+    return r.ok;
+}
+
+} // namespace net
@@ -0,0 +1,115 @@
+#pragma once
+
+// Wire format between snake_server and its clients. Every datagram starts
+// with a message type byte; integers are varints unless noted.
+//
+//   HELLO     version | width | height | cookie (8 bytes, LE)   client asks for a game
+//   COOKIE    cookie (8 bytes, LE)                       say HELLO again with this
+//   WELCOME   session | game | width | height | seed (8 bytes, LE)
+//   INPUT     session | game | ackTick | clientTick | count | { tick << 2 | direction }*
+//   SNAPSHOT  session | game | baseTick | moveCount | moves (2 bits each)
+//             | score | length | fruit cell | outcome
+//   RESTART   session                                    new game, same session
+//   BYE       session
+//
+// A game is fully determined by its seed and the direction the snake moved
+// on each tick, the same property replays rely on. So a snapshot is a delta
+// against the last tick the client acknowledged: the directions of the
+// ticks since then, from which the client re-runs the body, growth and
+// fruit itself. A one-tick delta is about a dozen bytes whatever the
+// snake's length. score, length and fruit ride along so a client can check
+// it stayed in sync. INPUT carries every turn the server has not confirmed
+// yet, so a lost packet costs no input.
+//
+// The server keeps nothing for an address it has not heard from before.
+// A HELLO without the right cookie only gets a COOKIE back, smaller than
+// the HELLO, so a spoofed source address can neither make the server set
+// up a game nor use it to send more than it received. The cookie is a
+// keyed hash of the client's address that the server can recompute.
+
+#include "SnakeSim.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace net {
+
+const std::uint8_t PROTOCOL_VERSION = 2;
+const std::uint16_t DEFAULT_PORT = 47100;
+const std::size_t MAX_PACKET = 1200;        // stays under a typical path MTU
+const std::uint32_t MAX_DELTA_TICKS = 2048; // moves per snapshot; longer gaps take several
+const std::size_t MAX_TURNS = 8;            // unconfirmed turns per INPUT
+
+enum MessageType : std::uint8_t { HELLO = 1, WELCOME, INPUT, SNAPSHOT, RESTART, BYE, COOKIE };
+
+struct Hello {
+    int width = SnakeSim::DEFAULT_GRID_WIDTH;
+    int height = SnakeSim::DEFAULT_GRID_HEIGHT;
+    std::uint64_t cookie = 0;   // from the server's COOKIE; 0 on the first try
+};
+
+struct Cookie {
+    std::uint64_t cookie = 0;
+};
+
+struct Welcome {
+    std::uint32_t session = 0;
+    std::uint32_t game = 0;     // bumped by RESTART
+    int width = 0;
+    int height = 0;
+    std::uint64_t seed = 0;
+};
+
+// Set the snake's direction before stepping to tick
+struct Turn {
+    std::uint64_t tick = 0;
+    Direction dir = Direction::RIGHT;
+};
+
+struct Input {
+    std::uint32_t session = 0;
+    std::uint32_t game = 0;
+    std::uint64_t ackTick = 0;      // latest tick the client has applied
+    std::uint64_t clientTick = 0;   // the client's predicted tick; 0 until it plays
+    Turn turns[MAX_TURNS];
+    std::size_t turnCount = 0;
+};
+
+// outcome: 0 while the game runs, else 1 + the final StepResult, plus
+// SNAPSHOT_CURRENT when the moves reach the server's latest tick. Only then
+// do score, length and fruitCell describe the state after the last move.
+const std::uint8_t SNAPSHOT_CURRENT = 0x80;
+
+struct Snapshot {
+    std::uint32_t session = 0;
+    std::uint32_t game = 0;
+    std::uint64_t baseTick = 0;
+    std::uint32_t moveCount = 0;
+    std::uint8_t moves[MAX_DELTA_TICKS];    // Direction of ticks baseTick + 1 ...
+    int score = 0;
+    std::uint32_t length = 0;
+    std::int32_t fruitCell = 0;             // y * width + x
+    std::uint8_t outcome = 0;
+};
+
+struct SessionMessage {
+    std::uint32_t session = 0;
+};
+
+// Encoders write at most MAX_PACKET bytes and return the size written
+std::size_t encode(const Hello& msg, std::uint8_t* out);
+std::size_t encode(const Cookie& msg, std::uint8_t* out);
+std::size_t encode(const Welcome& msg, std::uint8_t* out);
+std::size_t encode(const Input& msg, std::uint8_t* out);
+// moves points at msg.moveCount directions, which need not live in msg
+std::size_t encode(const Snapshot& msg, const std::uint8_t* moves, std::uint8_t* out);
+std::size_t encode(MessageType type, const SessionMessage& msg, std::uint8_t* out);
+
+// Decoders return false on a truncated or malformed datagram
+bool decode(const std::uint8_t* data, std::size_t size, Hello& msg);
+bool decode(const std::uint8_t* data, std::size_t size, Cookie& msg);
+bool decode(const std::uint8_t* data, std::size_t size, Welcome& msg);
+bool decode(const std::uint8_t* data, std::size_t size, Input& msg);
+bool decode(const std::uint8_t* data, std::size_t size, Snapshot& msg);
+bool decode(const std::uint8_t* data, std::size_t size, SessionMessage& msg);
+
+} // namespace net
@@ -0,0 +1,268 @@
+#include "NetServer.hpp"
+#include <algorithm>
+#include <random>
+
+namespace {
+const auto SESSION_TIMEOUT = std::chrono::seconds(5);
+// Resend cadence while a client is behind and nothing new happened
+const auto RESEND_INTERVAL = std::chrono::milliseconds(100);
+// Backlog caught up after a stall, as in Game::update()
+const auto MAX_FRAME_TIME = std::chrono::milliseconds(250);
+// A session's clock starts this many ticks behind its client, so turns
+// sent at the client's tick usually arrive before the server runs it
+const int SESSION_LEAD_TICKS = 1;
+// Turns may be queued at most this far ahead of the server
+const std::uint64_t MAX_TURN_LEAD = 64;
+// Acknowledged moves are dropped in batches of this many
+const std::uint64_t TRIM_TICKS = 4096;
+// A cookie is good for the period it was sent in and the next one
+const auto COOKIE_PERIOD = std::chrono::seconds(30);
+
+std::chrono::nanoseconds tickDuration(const SnakeSim& sim) {
+    return std::chrono::nanoseconds(static_cast<std::int64_t>(sim.getGameSpeed() * 1e6f));
+}
+}
+
+// NetServer Implementation
+NetServer::NetServer(std::size_t maxSessions, std::uint64_t seed, int maxBoardSide, std::size_t maxCells)
+    : seeds(seed)
+    , maxSessions(maxSessions)
+    , maxBoardSide(std::clamp(maxBoardSide, MIN_BOARD_SIDE, MAX_BOARD_SIDE))
+    , maxCells(maxCells) {
+    // Cookies need keys a client cannot guess, so not the game seed
+    std::random_device entropy;
+    for (std::uint64_t& key : cookieKeys) key = (static_cast<std::uint64_t>(entropy()) << 32) ^ entropy();
+}
+
+bool NetServer::open(std::uint16_t port) {
+    return socket.open(port);
+}
+
+void NetServer::receive() {
+    const Clock::time_point start = Clock::now();
+    NetAddress from;
+    for (long n; (n = socket.receive(packet, sizeof(packet), from)) >= 0;) {
+        ++stats.packetsIn;
+        stats.bytesIn += static_cast<std::uint64_t>(n);
+        handle(packet, static_cast<std::size_t>(n), from, start);
+    }
+    stats.receiveNs += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+void NetServer::handle(const std::uint8_t* data, std::size_t size, const NetAddress& from, Clock::time_point now) {
+    if (size == 0) return;
+    auto known = sessionByAddress.find(addressKey(from));
+    Session* session = known == sessionByAddress.end() ? nullptr : &sessions.at(known->second);
+    switch (data[0]) {
+        case net::HELLO: {
+            net::Hello hello;
+            if (!decode(data, size, hello)) return;
+            if (!session) {
+                // Nothing is kept until the sender shows it receives at its address
+                if (!validCookie(from, hello.cookie, now)) {
+                    sendCookie(from, now);
+                    return;
+                }
+                session = openSession(hello, from);
+                if (!session) return;
+            }
+            // Repeated HELLOs mean our WELCOME was lost
+            session->lastHeard = now;
+            sendWelcome(*session);
+            break;
+        }
+        case net::INPUT: {
+            net::Input input;
+            if (!session || !decode(data, size, input) || input.session != session->id) return;
+            session->lastHeard = now;
+            if (input.game != session->game) {
+                sendWelcome(*session);
+                return;
+            }
+            handleInput(*session, input);
+            break;
+        }
+        case net::RESTART: {
+            net::SessionMessage msg;
+            if (!session || !decode(data, size, msg) || msg.session != session->id) return;
+            session->lastHeard = now;
+            newGame(*session);
+            sendWelcome(*session);
+            break;
+        }
+        case net::BYE: {
+            net::SessionMessage msg;
+            if (session && decode(data, size, msg) && msg.session == session->id) close(session->id);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Cheap keyed hash of the address, not a cryptographic MAC: enough that a
+// sender who never sees our replies cannot produce it
+std::uint64_t NetServer::cookieFor(const NetAddress& address, std::uint64_t epoch) const {
+    const std::uint64_t h = SimRng(cookieKeys[0] ^ addressKey(address)).next();
+    return SimRng(h ^ cookieKeys[1] ^ epoch).next() | 1;   // never 0, the "no cookie yet" value
+}
+
+bool NetServer::validCookie(const NetAddress& address, std::uint64_t cookie, Clock::time_point now) const {
+    const std::uint64_t epoch = static_cast<std::uint64_t>(now.time_since_epoch() / COOKIE_PERIOD);
+    return cookie != 0 && (cookie == cookieFor(address, epoch) || cookie == cookieFor(address, epoch - 1));
+}
+
+void NetServer::sendCookie(const NetAddress& to, Clock::time_point now) {
+    net::Cookie msg;
+    msg.cookie = cookieFor(to, static_cast<std::uint64_t>(now.time_since_epoch() / COOKIE_PERIOD));
+    send(to, encode(msg, packet));
+    ++stats.cookiesSent;
+}
+
+NetServer::Session* NetServer::openSession(const net::Hello& hello, const NetAddress& from) {
+    const int width = std::clamp(hello.width, MIN_BOARD_SIDE, maxBoardSide);
+    const int height = std::clamp(hello.height, MIN_BOARD_SIDE, maxBoardSide);
+    const std::size_t cells = static_cast<std::size_t>(width) * height;
+    if (sessions.size() >= maxSessions || cellsInUse + cells > maxCells) {
+        ++stats.hellosRefused;
+        return nullptr;
+    }
+    const std::uint32_t id = nextSession++;
+    Session& session = sessions.emplace(std::piecewise_construct, std::forward_as_tuple(id),
+                                        std::forward_as_tuple(id, from, width, height, seeds.next())).first->second;
+    sessionByAddress[addressKey(from)] = id;
+    cellsInUse += cells;
+    ++stats.sessionsOpened;
+    return &session;
+}
+
+void NetServer::handleInput(Session& session, const net::Input& input) {
+    const std::uint64_t tick = session.sim.getTicks();
+    // The game's clock starts once the client starts playing it
+    if (!session.started && input.clientTick > 0) {
+        session.started = true;
+        session.accumulator = std::chrono::duration_cast<Clock::duration>(-SESSION_LEAD_TICKS * tickDuration(session.sim));
+    }
+    session.ackTick = std::max(session.ackTick, std::min(input.ackTick, tick));
+    for (std::size_t i = 0; i < input.turnCount; ++i) {
+        net::Turn turn = input.turns[i];
+        if (turn.tick <= session.lastTurnTick || turn.tick > tick + MAX_TURN_LEAD) continue;
+        session.lastTurnTick = turn.tick;
+        if (turn.tick <= tick) {
+            // Missed its tick: the next one is the earliest it can still take effect
+            turn.tick = tick + 1;
+            ++stats.lateTurns;
+        }
+        session.turns.push_back(turn);
+    }
+}
+
+void NetServer::newGame(Session& session) {
+    ++session.game;
+    session.sim.reset(seeds.next());
+    session.moves.clear();
+    session.movesBase = 0;
+    session.ackTick = 0;
+    session.turns.clear();
+    session.lastTurnTick = 0;
+    session.started = false;
+}
+
+void NetServer::update(Clock::time_point now) {
+    const Clock::time_point start = Clock::now();
+    const Clock::duration elapsed = updated ? std::min<Clock::duration>(now - lastUpdate, MAX_FRAME_TIME) : Clock::duration::zero();
+    lastUpdate = now;
+    updated = true;
+
+    const std::uint64_t ticksBefore = stats.sessionTicks;
+    std::vector<std::uint32_t> expired;
+    for (auto& entry : sessions) {
+        Session& session = entry.second;
+        if (now - session.lastHeard > SESSION_TIMEOUT) {
+            expired.push_back(entry.first);
+            continue;
+        }
+        advance(session, elapsed, now);
+    }
+    for (std::uint32_t id : expired) close(id);
+
+    if (stats.sessionTicks != ticksBefore) {
+        const std::uint64_t ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        ++stats.frames;
+        stats.updateNs += ns;
+        stats.maxUpdateNs = std::max(stats.maxUpdateNs, ns);
+    }
+}
+
+void NetServer::advance(Session& session, Clock::duration elapsed, Clock::time_point now) {
+    SnakeSim& sim = session.sim;
+    bool ticked = false;
+    if (session.started && !sim.isOver()) {
+        session.accumulator += elapsed;
+        for (auto tick = tickDuration(sim); session.accumulator >= tick; tick = tickDuration(sim)) {
+            session.accumulator -= tick;
+            // Turns are in arrival order; late ones were moved to the next tick
+            auto due = std::stable_partition(session.turns.begin(), session.turns.end(),
+                                             [&](const net::Turn& t) { return t.tick <= sim.getTicks() + 1; });
+            for (auto it = session.turns.begin(); it != due; ++it) sim.setDirection(it->dir);
+            session.turns.erase(session.turns.begin(), due);
+            session.result = sim.step();
+            session.moves.push_back(static_cast<std::uint8_t>(sim.getSnake().getDirection()));
+            ++stats.sessionTicks;
+            ticked = true;
+            if (sim.isOver()) break;
+        }
+    }
+    if (session.ackTick - session.movesBase >= TRIM_TICKS) {
+        session.moves.erase(session.moves.begin(), session.moves.begin() + static_cast<std::ptrdiff_t>(session.ackTick - session.movesBase));
+        session.movesBase = session.ackTick;
+    }
+    if (ticked || (session.ackTick < sim.getTicks() && now - session.lastSent >= RESEND_INTERVAL)) {
+        sendSnapshot(session, now);
+    }
+}
+
+void NetServer::sendWelcome(const Session& session) {
+    net::Welcome welcome;
+    welcome.session = session.id;
+    welcome.game = session.game;
+    welcome.width = session.sim.getGridWidth();
+    welcome.height = session.sim.getGridHeight();
+    welcome.seed = session.sim.getSeed();
+    send(session.address, encode(welcome, packet));
+}
+
+void NetServer::sendSnapshot(Session& session, Clock::time_point now) {
+    const SnakeSim& sim = session.sim;
+    const std::uint64_t pending = sim.getTicks() - session.ackTick;
+    snapshot.session = session.id;
+    snapshot.game = session.game;
+    snapshot.baseTick = session.ackTick;
+    snapshot.moveCount = static_cast<std::uint32_t>(std::min<std::uint64_t>(pending, net::MAX_DELTA_TICKS));
+    snapshot.score = sim.getScore();
+    snapshot.length = static_cast<std::uint32_t>(sim.getSnake().getLength());
+    const Position& fruit = sim.getFruit().getPosition();
+    snapshot.fruitCell = fruit.y * sim.getGridWidth() + fruit.x;
+    snapshot.outcome = 0;
+    if (sim.isOver()) snapshot.outcome = static_cast<std::uint8_t>(1 + static_cast<int>(session.result));
+    if (snapshot.moveCount == pending) snapshot.outcome |= net::SNAPSHOT_CURRENT;
+    const std::uint8_t* moves = session.moves.data() + (session.ackTick - session.movesBase);
+    send(session.address, encode(snapshot, moves, packet));
+    session.lastSent = now;
+}
+
+void NetServer::send(const NetAddress& to, std::size_t size) {
+    if (!socket.sendTo(to, packet, size)) return;
+    ++stats.packetsOut;
+    stats.bytesOut += size;
+}
+
+void NetServer::close(std::uint32_t id) {
+    auto it = sessions.find(id);
+    if (it == sessions.end()) return;
+    const SnakeSim& sim = it->second.sim;
+    cellsInUse -= static_cast<std::size_t>(sim.getGridWidth()) * sim.getGridHeight();
+    sessionByAddress.erase(addressKey(it->second.address));
+    sessions.erase(it);
+    ++stats.sessionsClosed;
+}
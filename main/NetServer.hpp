@@ -0,0 +1,119 @@
+#pragma once
+
+// Authoritative headless game server. Each client that says HELLO gets its
+// own SnakeSim session, paced like Game::update(): a fixed tick of the
+// game's current speed, fed from the wall clock. Turns from INPUT are
+// applied on the tick they were made for (or the next one, if they arrive
+// late), and after every frame that advanced a session its client gets a
+// snapshot delta against the tick it last acknowledged. No SFML involved.
+//
+// A HELLO opens a session only once it echoes the cookie the server sent
+// to its address, and boards are capped per session and in total, so
+// memory grows only with clients that can receive at their address.
+
+#include "SnakeSim.hpp"
+#include "NetProtocol.hpp"
+#include "NetSocket.hpp"
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class NetServer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        std::uint64_t frames = 0;           // update() calls that ticked a session
+        std::uint64_t sessionTicks = 0;
+        std::uint64_t updateNs = 0;         // CPU in update() over those frames
+        std::uint64_t maxUpdateNs = 0;
+        std::uint64_t receiveNs = 0;        // CPU decoding and applying datagrams
+        std::uint64_t packetsIn = 0;
+        std::uint64_t packetsOut = 0;
+        std::uint64_t bytesIn = 0;
+        std::uint64_t bytesOut = 0;
+        std::uint64_t lateTurns = 0;        // applied a tick after the one asked for
+        std::uint64_t sessionsOpened = 0;
+        std::uint64_t sessionsClosed = 0;
+        std::uint64_t cookiesSent = 0;      // HELLOs without a valid cookie
+        std::uint64_t hellosRefused = 0;    // over the session or cell limit
+    };
+
+private:
+    struct Session {
+        std::uint32_t id;
+        std::uint32_t game = 0;
+        NetAddress address;
+        SnakeSim sim;
+        StepResult result = StepResult::MOVED;  // of the latest tick
+        std::vector<std::uint8_t> moves;    // direction of tick movesBase + 1 + i
+        std::uint64_t movesBase = 0;
+        std::uint64_t ackTick = 0;
+        std::vector<net::Turn> turns;       // queued by tick
+        std::uint64_t lastTurnTick = 0;     // newest turn accepted; older resends are dropped
+        bool started = false;               // clock runs once the client plays
+        Clock::duration accumulator{};
+        Clock::time_point lastHeard;
+        Clock::time_point lastSent;
+
+        Session(std::uint32_t id, const NetAddress& address, int width, int height, std::uint64_t seed)
+            : id(id), address(address), sim(width, height, seed) {}
+    };
+
+    UdpSocket socket;
+    std::unordered_map<std::uint32_t, Session> sessions;
+    std::unordered_map<std::uint64_t, std::uint32_t> sessionByAddress;
+    std::uint32_t nextSession = 1;
+    SimRng seeds;
+    std::size_t maxSessions;
+    int maxBoardSide;
+    std::size_t maxCells;                   // over all sessions' boards
+    std::size_t cellsInUse = 0;
+    std::uint64_t cookieKeys[2];
+    Clock::time_point lastUpdate;
+    bool updated = false;
+    Stats stats;
+    std::uint8_t packet[net::MAX_PACKET];
+    net::Snapshot snapshot;                 // scratch; large
+
+    static std::uint64_t addressKey(const NetAddress& a) { return (static_cast<std::uint64_t>(a.ip) << 16) | a.port; }
+    std::uint64_t cookieFor(const NetAddress& address, std::uint64_t epoch) const;
+    bool validCookie(const NetAddress& address, std::uint64_t cookie, Clock::time_point now) const;
+    void sendCookie(const NetAddress& to, Clock::time_point now);
+    Session* openSession(const net::Hello& hello, const NetAddress& from);
+    void handle(const std::uint8_t* data, std::size_t size, const NetAddress& from, Clock::time_point now);
+    void handleInput(Session& session, const net::Input& input);
+    void newGame(Session& session);
+    void advance(Session& session, Clock::duration elapsed, Clock::time_point now);
+    void sendWelcome(const Session& session);
+    void sendSnapshot(Session& session, Clock::time_point now);
+    void send(const NetAddress& to, std::size_t size);
+    void close(std::uint32_t id);
+
+public:
+    static constexpr int MIN_BOARD_SIDE = 8;
+    static constexpr int MAX_BOARD_SIDE = 4096;
+    static constexpr int DEFAULT_MAX_BOARD_SIDE = 64;
+    static constexpr std::size_t DEFAULT_MAX_CELLS = std::size_t(1) << 23;
+
+    // seed feeds the per-game seeds, so a run can be repeated. Requested
+    // boards are clamped to maxBoardSide a side, and a HELLO is turned away
+    // while its board would take the sessions past maxCells in total.
+    explicit NetServer(std::size_t maxSessions = 4096, std::uint64_t seed = 0,
+                       int maxBoardSide = DEFAULT_MAX_BOARD_SIDE, std::size_t maxCells = DEFAULT_MAX_CELLS);
+    bool open(std::uint16_t port);
+    std::uint16_t port() const { return socket.localPort(); }
+    // Blocks until a datagram is waiting or timeoutMs passes
+    void wait(int timeoutMs) { socket.wait(timeoutMs); }
+    // Handles every waiting datagram
+    void receive();
+    // Runs the ticks that fell due since the last call, sends snapshots and
+    // drops sessions that went quiet
+    void update(Clock::time_point now);
+    std::size_t getSessionCount() const { return sessions.size(); }
+    std::size_t getCellsInUse() const { return cellsInUse; }
+    const Stats& getStats() const { return stats; }
+    // Test hook: drops this fraction of the datagrams sent to clients
+    void simulateLoss(double fraction, std::uint64_t seed) { socket.simulateLoss(fraction, seed); }
+};
@@ -0,0 +1,123 @@
+#include "NetSocket.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#if !defined(_WIN32)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// splitmix64, as SimRng
+std::uint64_t nextLossRoll(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Room for bursts of snapshots to many clients before the kernel drops them
+const int SOCKET_BUFFER_BYTES = 4 << 20;
+}
+
+// NetAddress Implementation
+bool NetAddress::parse(const std::string& text, NetAddress& out) {
+    const std::size_t colon = text.rfind(':');
+    if (colon == std::string::npos || colon + 1 >= text.size()) return false;
+    char* end = nullptr;
+    const unsigned long port = std::strtoul(text.c_str() + colon + 1, &end, 10);
+    if (*end != '\0' || port == 0 || port > 0xFFFF) return false;
+    const std::string host = text.substr(0, colon);
+    if (host.empty() || host == "localhost") {
+        out = loopback(static_cast<std::uint16_t>(port));
+        return true;
+    }
+    unsigned a, b, c, d;
+    char extra;
+    if (std::sscanf(host.c_str(), "%u.%u.%u.%u%c", &a, &b, &c, &d, &extra) != 4 || a > 255 || b > 255 || c > 255 || d > 255) {
+        return false;
+    }
+    out.ip = (a << 24) | (b << 16) | (c << 8) | d;
+    out.port = static_cast<std::uint16_t>(port);
+    return true;
+}
+
+std::string NetAddress::toString() const {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%u.%u.%u.%u:%u", ip >> 24, (ip >> 16) & 0xFF, (ip >> 8) & 0xFF, ip & 0xFF, port);
+    return text;
+}
+
+// UdpSocket Implementation
+void UdpSocket::simulateLoss(double fraction, std::uint64_t seed) {
+    lossThreshold = static_cast<std::uint32_t>(std::min(std::max(fraction, 0.0), 0.999) * 4294967296.0);
+    lossState = seed;
+}
+
+#if !defined(_WIN32)
+bool UdpSocket::open(std::uint16_t port) {
+    close();
+    fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return false;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK) != 0) {
+        close();
+        return false;
+    }
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &SOCKET_BUFFER_BYTES, sizeof(SOCKET_BUFFER_BYTES));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &SOCKET_BUFFER_BYTES, sizeof(SOCKET_BUFFER_BYTES));
+    return true;
+}
+
+void UdpSocket::close() {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
+
+std::uint16_t UdpSocket::localPort() const {
+    sockaddr_in addr{};
+    socklen_t size = sizeof(addr);
+    if (fd < 0 || ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &size) != 0) return 0;
+    return ntohs(addr.sin_port);
+}
+
+bool UdpSocket::sendTo(const NetAddress& to, const std::uint8_t* data, std::size_t size) {
+    if (lossThreshold && static_cast<std::uint32_t>(nextLossRoll(lossState) >> 32) < lossThreshold) return true;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(to.ip);
+    addr.sin_port = htons(to.port);
+    return ::sendto(fd, data, size, 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == static_cast<ssize_t>(size);
+}
+
+long UdpSocket::receive(std::uint8_t* buffer, std::size_t capacity, NetAddress& from) {
+    sockaddr_in addr{};
+    socklen_t size = sizeof(addr);
+    const ssize_t n = ::recvfrom(fd, buffer, capacity, 0, reinterpret_cast<sockaddr*>(&addr), &size);
+    if (n < 0) return -1;
+    from.ip = ntohl(addr.sin_addr.s_addr);
+    from.port = ntohs(addr.sin_port);
+    return static_cast<long>(n);
+}
+
+bool UdpSocket::wait(int timeoutMs) {
+    pollfd p{fd, POLLIN, 0};
+    return ::poll(&p, 1, timeoutMs) > 0;
+}
+#else
+bool UdpSocket::open(std::uint16_t) { return false; }
+void UdpSocket::close() {}
+std::uint16_t UdpSocket::localPort() const { return 0; }
+bool UdpSocket::sendTo(const NetAddress&, const std::uint8_t*, std::size_t) { return false; }
+long UdpSocket::receive(std::uint8_t*, std::size_t, NetAddress&) { return -1; }
+bool UdpSocket::wait(int) { return false; }
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// IPv4 address and port, both in host byte order.
+struct NetAddress {
+    std::uint32_t ip = 0;
+    std::uint16_t port = 0;
+
+    bool operator==(const NetAddress& other) const { return ip == other.ip && port == other.port; }
+    bool operator!=(const NetAddress& other) const { return !(*this == other); }
+    // Parses "a.b.c.d:port", "localhost:port" or ":port" (loopback)
+    static bool parse(const std::string& text, NetAddress& out);
+    static NetAddress loopback(std::uint16_t port) { return NetAddress{0x7F000001u, port}; }
+    std::string toString() const;
+};
+
+// Non-blocking UDP socket over POSIX sockets. Not available on Windows,
+// where open() fails.
+class UdpSocket {
+private:
+    int fd = -1;
+    std::uint32_t lossThreshold = 0;    // out of 2^32
+    std::uint64_t lossState = 0;
+
+public:
+    UdpSocket() = default;
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+    ~UdpSocket() { close(); }
+    // Binds to port on every interface; port 0 picks a free one
+    bool open(std::uint16_t port = 0);
+    void close();
+    bool isOpen() const { return fd >= 0; }
+    std::uint16_t localPort() const;
+    bool sendTo(const NetAddress& to, const std::uint8_t* data, std::size_t size);
+    // Size of the datagram read into buffer, or -1 when none is waiting
+    long receive(std::uint8_t* buffer, std::size_t capacity, NetAddress& from);
+    // Blocks until a datagram is waiting or timeoutMs passes
+    bool wait(int timeoutMs);
+    // Test hook: silently drops this fraction of outgoing datagrams
+    void simulateLoss(double fraction, std::uint64_t seed);
+};
@@ -0,0 +1,60 @@
+#include "PhasePool.hpp"
+#include <algorithm>
+
+namespace {
+// Yields before a worker goes to sleep between phases
+const int SPIN_LIMIT = 2000;
+}
+
+// PhasePool Implementation
+PhasePool::PhasePool(unsigned threads) : threadCount(std::max(1u, threads)) {
+    workers.reserve(threadCount - 1);
+    for (unsigned i = 1; i < threadCount; ++i) {
+        workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+PhasePool::~PhasePool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping.store(true, std::memory_order_relaxed);
+        generation.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+void PhasePool::dispatch(std::size_t n, Trampoline fn, void* ctx) {
+    trampoline = fn;
+    context = ctx;
+    count = n;
+    pending.store(static_cast<unsigned>(workers.size()), std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_all();
+
+    fn(ctx, 0, rangeStart(1));
+    while (pending.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+}
+
+void PhasePool::workerLoop(unsigned index) {
+    std::uint64_t seen = 0;
+    for (;;) {
+        std::uint64_t current = generation.load(std::memory_order_acquire);
+        for (int spins = 0; current == seen; current = generation.load(std::memory_order_acquire)) {
+            if (++spins < SPIN_LIMIT) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return generation.load(std::memory_order_acquire) != seen; });
+        }
+        seen = current;
+        if (stopping.load(std::memory_order_relaxed)) return;
+        const std::size_t end = index + 1 < threadCount ? rangeStart(index + 1) : count;
+        trampoline(context, rangeStart(index), end);
+        pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+// Persistent worker threads for short, repeated fork-join phases (one
+// arena tick runs several). run() splits [0, count) into one contiguous
+// range per thread, runs range 0 on the calling thread and returns once
+// every range is done. Workers spin briefly between phases before
+// sleeping, so back-to-back phases do not pay a full wake-up each time.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class PhasePool {
+private:
+    using Trampoline = void (*)(void* context, std::size_t begin, std::size_t end);
+
+    std::vector<std::thread> workers;
+    unsigned threadCount;
+
+    // Current phase; written before generation is bumped
+    Trampoline trampoline = nullptr;
+    void* context = nullptr;
+    std::size_t count = 0;
+
+    std::atomic<std::uint64_t> generation{0};
+    std::atomic<unsigned> pending{0};
+    std::atomic<bool> stopping{false};
+    std::mutex mutex;
+    std::condition_variable wake;
+
+    void workerLoop(unsigned index);
+    void dispatch(std::size_t n, Trampoline fn, void* ctx);
+    std::size_t rangeStart(unsigned index) const { return count * index / threadCount; }
+
+public:
+    // threads includes the caller; 1 runs every phase inline
+    explicit PhasePool(unsigned threads);
+    ~PhasePool();
+    PhasePool(const PhasePool&) = delete;
+    PhasePool& operator=(const PhasePool&) = delete;
+
+    unsigned size() const { return threadCount; }
+
+    // fn(begin, end) must be safe to call concurrently on disjoint ranges
+    template <typename Fn>
+    void run(std::size_t n, Fn& fn) {
+        if (workers.empty() || n < threadCount) {
+            if (n) fn(std::size_t(0), n);
+            return;
+        }
+        dispatch(n, [](void* ctx, std::size_t begin, std::size_t end) { (*static_cast<Fn*>(ctx))(begin, end); }, &fn);
+    }
+};
@@ -0,0 +1,120 @@
+#include "Profiler.hpp"
+
+#ifdef SNAKE_PROFILE
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace profiler {
+
+namespace {
+
+const std::size_t RING_CAPACITY = 1 << 16; // events per thread
+
+struct ThreadRing {
+    std::unique_ptr<Event[]> events{ new Event[RING_CAPACITY] };
+    std::atomic<std::uint64_t> written{ 0 };
+    std::uint32_t threadId = 0;
+};
+
+const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+// Rings are registered once per thread and kept alive until exit so a dump
+// can still read threads that have finished.
+std::mutex ringsMutex;
+std::vector<std::unique_ptr<ThreadRing>> rings;
+
+ThreadRing& threadRing() {
+    thread_local ThreadRing* ring = [] {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        rings.push_back(std::make_unique<ThreadRing>());
+        rings.back()->threadId = static_cast<std::uint32_t>(rings.size());
+        return rings.back().get();
+    }();
+    return *ring;
+}
+
+// Frame history is only touched by the thread that calls endFrame()
+float frameRing[FRAME_HISTORY] = {};
+std::size_t frameCount = 0;
+std::uint64_t lastFrameNs = 0;
+
+} // namespace
+
+std::uint64_t nowNs() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count());
+}
+
+void record(const char* name, std::uint64_t startNs, std::uint64_t endNs) {
+    ThreadRing& ring = threadRing();
+    std::uint64_t n = ring.written.load(std::memory_order_relaxed);
+    ring.events[n % RING_CAPACITY] = Event{ name, startNs, endNs - startNs };
+    ring.written.store(n + 1, std::memory_order_release);
+}
+
+void endFrame() {
+    std::uint64_t now = nowNs();
+    if (lastFrameNs != 0) {
+        frameRing[frameCount % FRAME_HISTORY] = (now - lastFrameNs) / 1e6f;
+        ++frameCount;
+    }
+    lastFrameNs = now;
+    record("frame", now, now);
+}
+
+FrameStats frameStats() {
+    FrameStats stats{};
+    stats.count = std::min(frameCount, FRAME_HISTORY);
+    std::size_t first = frameCount - stats.count;
+    for (std::size_t i = 0; i < stats.count; ++i) {
+        stats.frameMs[i] = frameRing[(first + i) % FRAME_HISTORY];
+    }
+    if (stats.count == 0) return stats;
+
+    float sorted[FRAME_HISTORY];
+    std::copy(stats.frameMs, stats.frameMs + stats.count, sorted);
+    std::sort(sorted, sorted + stats.count);
+    stats.p50Ms = sorted[stats.count / 2];
+    stats.p99Ms = sorted[std::min(stats.count - 1, stats.count * 99 / 100)];
+    stats.maxMs = sorted[stats.count - 1];
+    return stats;
+}
+
+bool writeChromeTrace(const std::string& path) {
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+
+    std::fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    for (const auto& ring : rings) {
+        std::fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                     first ? "" : ",\n", ring->threadId, ring->threadId == 1 ? "main" : "worker");
+        first = false;
+
+        std::uint64_t end = ring->written.load(std::memory_order_acquire);
+        std::uint64_t begin = end > RING_CAPACITY ? end - RING_CAPACITY : 0;
+        for (std::uint64_t i = begin; i < end; ++i) {
+            const Event& e = ring->events[i % RING_CAPACITY];
+            if (e.durationNs == 0) {
+                std::fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}",
+                             e.name, ring->threadId, e.startNs / 1e3);
+            } else {
+                std::fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                             e.name, ring->threadId, e.startNs / 1e3, e.durationNs / 1e3);
+            }
+        }
+    }
+    std::fprintf(out, "\n]}\n");
+    return std::fclose(out) == 0;
+}
+
+} // namespace profiler
+
+#endif
@@ -0,0 +1,74 @@
+#pragma once
+
+// Scoped-timer instrumentation. Built only with -DSNAKE_PROFILE (make
+// profile); otherwise every macro expands to nothing and no profiler code
+// is compiled.
+//
+//   PROFILE_SCOPE("render");   // times the enclosing block
+//   PROFILE_FRAME();           // marks the end of a frame
+//
+// Each thread records into its own fixed-size ring buffer, allocated once
+// on the thread's first event, so the hot path never allocates or locks.
+// Older events are overwritten once the ring is full.
+
+#ifdef SNAKE_PROFILE
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) profiler::ScopedTimer PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FRAME() profiler::endFrame()
+
+namespace profiler {
+
+struct Event {
+    const char* name;        // must be a string literal
+    std::uint64_t startNs;   // since profiler start
+    std::uint64_t durationNs;
+};
+
+std::uint64_t nowNs();
+void record(const char* name, std::uint64_t startNs, std::uint64_t endNs);
+
+class ScopedTimer {
+private:
+    const char* name;
+    std::uint64_t start;
+
+public:
+    explicit ScopedTimer(const char* name) : name(name), start(nowNs()) {}
+    ~ScopedTimer() { record(name, start, nowNs()); }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+// Frame times of the last FRAME_HISTORY frames, oldest first
+const std::size_t FRAME_HISTORY = 240;
+
+struct FrameStats {
+    float frameMs[FRAME_HISTORY];
+    std::size_t count;
+    float p50Ms;
+    float p99Ms;
+    float maxMs;
+};
+
+void endFrame();
+FrameStats frameStats();
+
+// Writes every buffered event as Chrome/Perfetto trace-event JSON
+// (chrome://tracing, ui.perfetto.dev). Events racing the dump on other
+// threads may be dropped.
+bool writeChromeTrace(const std::string& path);
+
+} // namespace profiler
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+
+#endif
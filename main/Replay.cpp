@@ -0,0 +1,173 @@
+#include "Replay.hpp"
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+const char MAGIC[4] = { 'S', 'N', 'K', 'R' };
+const std::uint8_t VERSION = 1;
+
+void putVarint(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(v) | 0x80);
+        v >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(v));
+}
+
+bool getVarint(const std::uint8_t* bytes, size_t length, size_t& offset, std::uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64 && offset < length; shift += 7) {
+        std::uint8_t b = bytes[offset++];
+        v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+// ReplayRecorder Implementation
+void ReplayRecorder::begin(int gridWidth, int gridHeight, std::uint64_t seed) {
+    bytes.assign(MAGIC, MAGIC + 4);
+    bytes.push_back(VERSION);
+    putVarint(bytes, static_cast<std::uint64_t>(gridWidth));
+    putVarint(bytes, static_cast<std::uint64_t>(gridHeight));
+    for (int i = 0; i < 8; ++i) {
+        bytes.push_back(static_cast<std::uint8_t>(seed >> (8 * i)));
+    }
+    recordsOffset = bytes.size();
+    lastTick = 0;
+    finished = false;
+}
+
+void ReplayRecorder::record(std::uint64_t tick, Direction dir) {
+    if (!isRecording() || tick <= lastTick) return;
+    putVarint(bytes, ((tick - lastTick) << 2) | static_cast<std::uint64_t>(dir));
+    lastTick = tick;
+}
+
+void ReplayRecorder::finish(std::uint64_t endTick) {
+    if (!isRecording()) return;
+    putVarint(bytes, 0);
+    putVarint(bytes, endTick);
+    finished = true;
+}
+
+void ReplayRecorder::truncate(std::uint64_t tick) {
+    if (bytes.empty()) return;
+    size_t offset = recordsOffset;
+    size_t keep = offset;
+    std::uint64_t at = 0;
+    std::uint64_t v = 0;
+    while (getVarint(bytes.data(), bytes.size(), offset, v) && v != 0 && at + (v >> 2) <= tick) {
+        at += v >> 2;
+        keep = offset;
+    }
+    bytes.resize(keep);
+    lastTick = at;
+    finished = false;
+}
+
+bool ReplayRecorder::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(out);
+}
+
+// ReplayReader Implementation
+bool ReplayReader::open(const std::string& path) {
+    if (!file.open(path)) return false;
+    bytes = file.data();
+    length = file.size();
+    return parse();
+}
+
+bool ReplayReader::openMemory(const std::uint8_t* data, size_t size) {
+    file.close();
+    bytes = data;
+    length = size;
+    return parse();
+}
+
+bool ReplayReader::parse() {
+    size_t offset = 0;
+    if (length < 5 || std::memcmp(bytes, MAGIC, 4) != 0 || bytes[4] != VERSION) return false;
+    offset = 5;
+    std::uint64_t w = 0, h = 0;
+    if (!getVarint(bytes, length, offset, w) || !getVarint(bytes, length, offset, h)) return false;
+    if (w == 0 || h == 0 || offset + 8 > length) return false;
+    gridWidth = static_cast<int>(w);
+    gridHeight = static_cast<int>(h);
+    seed = 0;
+    for (int i = 0; i < 8; ++i) {
+        seed |= static_cast<std::uint64_t>(bytes[offset++]) << (8 * i);
+    }
+    recordsOffset = offset;
+
+    // One linear pass to validate the stream and find the end tick
+    Cursor cursor = first();
+    while (!cursor.done) next(cursor);
+    std::uint64_t v = 0;
+    offset = cursor.offset;
+    if (!getVarint(bytes, length, offset, v) || v != 0) return false;
+    return getVarint(bytes, length, offset, endTick);
+}
+
+ReplayReader::Cursor ReplayReader::first() const {
+    Cursor cursor;
+    cursor.offset = recordsOffset;
+    cursor.done = false;
+    next(cursor);
+    return cursor;
+}
+
+void ReplayReader::next(Cursor& cursor) const {
+    size_t offset = cursor.offset;
+    std::uint64_t v = 0;
+    if (!getVarint(bytes, length, offset, v) || v == 0) {
+        // Terminator (or truncated data): leave offset at it
+        cursor.done = true;
+        return;
+    }
+    cursor.offset = offset;
+    cursor.tick += v >> 2;
+    cursor.dir = static_cast<Direction>(v & 3);
+    cursor.done = false;
+}
+
+// ReplayPlayer Implementation
+ReplayPlayer::ReplayPlayer(const ReplayReader& reader, SnakeSim& sim)
+    : reader(reader)
+    , sim(sim) {
+    const std::uint64_t defaultCells = static_cast<std::uint64_t>(SnakeSim::DEFAULT_GRID_WIDTH) * SnakeSim::DEFAULT_GRID_HEIGHT;
+    const std::uint64_t cells = static_cast<std::uint64_t>(reader.getGridWidth()) * reader.getGridHeight();
+    keyframeInterval = KEYFRAME_INTERVAL * std::max<std::uint64_t>(1, cells / defaultCells);
+    sim.reset(reader.getSeed());
+    cursor = reader.first();
+    keyframes.push_back(Keyframe{sim, cursor});
+}
+
+StepResult ReplayPlayer::step() {
+    if (!cursor.done && cursor.tick == sim.getTicks() + 1) {
+        sim.setDirection(cursor.dir);
+        reader.next(cursor);
+    }
+    StepResult result = sim.step();
+    if (sim.getTicks() == keyframes.size() * keyframeInterval) {
+        keyframes.push_back(Keyframe{sim, cursor});
+    }
+    return result;
+}
+
+void ReplayPlayer::seek(std::uint64_t tick) {
+    size_t index = static_cast<size_t>(std::min<std::uint64_t>(tick / keyframeInterval, keyframes.size() - 1));
+    // Going forward from the current position is cheaper than restoring
+    if (!(sim.getTicks() <= tick && sim.getTicks() >= index * keyframeInterval)) {
+        sim = keyframes[index].state;
+        cursor = keyframes[index].cursor;
+    }
+    while (sim.getTicks() < tick && !isFinished()) {
+        step();
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+// Compact deterministic replays. A replay is the RNG seed plus the turns
+// that took effect, so a whole session is typically a few hundred bytes:
+//
+//   "SNKR" | version (1 byte) | varint width | varint height | seed (8 bytes, LE)
+//   { varint (tickDelta << 2 | direction) }*   turn applied on that tick
+//   varint 0 | varint endTick                  terminator
+//
+// Playback re-runs SnakeSim with the same seed, applying each turn on its
+// tick, and keeps periodic SnakeSim keyframes so seeking only re-simulates
+// from the nearest earlier keyframe.
+
+#include "SnakeSim.hpp"
+#include "MappedFile.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ReplayRecorder {
+private:
+    std::vector<std::uint8_t> bytes;
+    size_t recordsOffset = 0;
+    std::uint64_t lastTick = 0;
+    bool finished = false;
+
+public:
+    void begin(int gridWidth, int gridHeight, std::uint64_t seed);
+    void record(std::uint64_t tick, Direction dir);
+    void finish(std::uint64_t endTick);
+    // Drops turns after tick (and the terminator, if finished) so recording
+    // carries on from there, as after a rewind
+    void truncate(std::uint64_t tick);
+    bool isRecording() const { return !bytes.empty() && !finished; }
+    bool save(const std::string& path) const;
+    const std::vector<std::uint8_t>& data() const { return bytes; }
+};
+
+class ReplayReader {
+public:
+    struct Cursor {
+        size_t offset = 0;          // of the next undecoded record
+        std::uint64_t tick = 0;     // tick of the pending turn
+        Direction dir = Direction::RIGHT;
+        bool done = true;           // no pending turn
+    };
+
+private:
+    MappedFile file;
+    const std::uint8_t* bytes = nullptr;
+    size_t length = 0;
+    size_t recordsOffset = 0;
+    int gridWidth = 0;
+    int gridHeight = 0;
+    std::uint64_t seed = 0;
+    std::uint64_t endTick = 0;
+    bool parse();
+
+public:
+    bool open(const std::string& path);
+    // The buffer must outlive the reader
+    bool openMemory(const std::uint8_t* data, size_t size);
+    int getGridWidth() const { return gridWidth; }
+    int getGridHeight() const { return gridHeight; }
+    std::uint64_t getSeed() const { return seed; }
+    std::uint64_t getEndTick() const { return endTick; }
+    Cursor first() const;
+    void next(Cursor& cursor) const;
+};
+
+class ReplayPlayer {
+private:
+    struct Keyframe {
+        SnakeSim state;
+        ReplayReader::Cursor cursor;
+    };
+
+    const ReplayReader& reader;
+    SnakeSim& sim;
+    ReplayReader::Cursor cursor;
+    std::vector<Keyframe> keyframes;    // keyframes[i] is at tick i * keyframeInterval
+    std::uint64_t keyframeInterval;
+
+public:
+    // Ticks between keyframes on the default board. A keyframe copies the
+    // whole sim, so larger boards space them out to keep memory per tick
+    // roughly constant.
+    static const std::uint64_t KEYFRAME_INTERVAL = 256;
+
+    // Resets sim to the replay's seed
+    ReplayPlayer(const ReplayReader& reader, SnakeSim& sim);
+    // Applies the recorded turn for the next tick, if any, and steps sim
+    StepResult step();
+    // Restores the closest keyframe at or before tick and re-simulates to it
+    void seek(std::uint64_t tick);
+    void restart() { seek(0); }
+    bool isFinished() const { return sim.isOver() || sim.getTicks() >= reader.getEndTick(); }
+};
@@ -0,0 +1,109 @@
+#include "Rewind.hpp"
+
+namespace {
+
+// Record layout: bits 0-1 heading before the tick, bits 2-3 the direction
+// from the new tail to the cell the old tail left, then two flags
+const std::uint8_t GREW = 1 << 4;
+const std::uint8_t SPED = 1 << 5;
+
+Direction heading(std::uint8_t record) {
+    return static_cast<Direction>(record & 3);
+}
+
+Direction tailSide(std::uint8_t record) {
+    return static_cast<Direction>((record >> 2) & 3);
+}
+
+Direction sideOf(const Position& from, const Position& to) {
+    for (Direction dir : { Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT }) {
+        if (from + directionVector(dir) == to) return dir;
+    }
+    return Direction::RIGHT;
+}
+
+} // namespace
+
+// RewindBuffer Implementation
+RewindBuffer::RewindBuffer(size_t capacity) : ticks(capacity > 0 ? capacity : 1), eats(ticks.size()) {}
+
+void RewindBuffer::clear() {
+    first = 0;
+    count = 0;
+    eatFirst = 0;
+    eatCount = 0;
+    newestTick = 0;
+}
+
+StepResult RewindBuffer::step(SnakeSim& sim) {
+    if (sim.isOver()) {
+        return sim.step();
+    }
+    if (count > 0 && sim.getTicks() != newestTick) {
+        // Stepped elsewhere since; what we hold no longer leads here
+        clear();
+    }
+    StepUndo undo;
+    const StepResult result = sim.step(undo);
+
+    std::uint8_t record = static_cast<std::uint8_t>(undo.direction);
+    if (undo.grew) {
+        record |= GREW;
+        if (undo.sped) record |= SPED;
+        if (eatCount == eats.size()) {
+            eatFirst = (eatFirst + 1) % eats.size();
+            --eatCount;
+        }
+        eats[(eatFirst + eatCount) % eats.size()] = EatRecord{undo.fruitRng, undo.headSlot};
+        ++eatCount;
+    } else {
+        record |= static_cast<std::uint8_t>(sideOf(sim.getSnake().getBody().back(), undo.tail)) << 2;
+    }
+    if (count == ticks.size()) {
+        // Full: the oldest tick drops out
+        if (ticks[first] & GREW) {
+            eatFirst = (eatFirst + 1) % eats.size();
+            --eatCount;
+        }
+        first = (first + 1) % ticks.size();
+        --count;
+    }
+    ++count;
+    at(count - 1) = record;
+    newestTick = sim.getTicks();
+    return result;
+}
+
+bool RewindBuffer::undo(SnakeSim& sim) {
+    if (count == 0 || sim.getTicks() != newestTick || sim.getTicks() == 0) {
+        return false;
+    }
+    const std::uint8_t record = at(count - 1);
+    const Position tail = sim.getSnake().getBody().back();
+    StepUndo undo;
+    undo.direction = heading(record);
+    undo.grew = (record & GREW) != 0;
+    undo.sped = (record & SPED) != 0;
+    if (undo.grew) {
+        const EatRecord& eat = eats[(eatFirst + eatCount - 1) % eats.size()];
+        undo.fruitRng = eat.fruitRng;
+        undo.headSlot = eat.headSlot;
+        undo.tail = tail;
+    } else {
+        undo.tail = tail + directionVector(tailSide(record));
+    }
+    // The cell the tail left a tick earlier, for interpolation: from the
+    // record before, or the cell behind a new snake's tail
+    if (count > 1) {
+        const std::uint8_t previous = at(count - 2);
+        undo.lastTail = (previous & GREW) ? undo.tail : undo.tail + directionVector(tailSide(previous));
+    } else {
+        undo.lastTail = sim.getTicks() == 1 ? undo.tail + directionVector(Direction::LEFT) : undo.tail;
+    }
+
+    sim.unstep(undo);
+    if (undo.grew) --eatCount;
+    --count;
+    newestTick = sim.getTicks();
+    return true;
+}
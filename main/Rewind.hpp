@@ -0,0 +1,44 @@
+#pragma once
+
+// Rewind history for a local game. Each tick leaves a compact undo record
+// in a fixed-capacity ring: one byte for the heading before the tick, the
+// side the tail left by and whether the snake ate (and sped up), plus the
+// fruit's old RNG state and free-cell slot for ticks that ate. Undoing a
+// tick is O(1) and exact (see SnakeSim::unstep), so stepping back never
+// needs a snapshot of the board, and memory is fixed at construction
+// however long the session runs. Once full, the oldest ticks drop out.
+
+#include "SnakeSim.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class RewindBuffer {
+private:
+    struct EatRecord {
+        std::uint64_t fruitRng;
+        std::uint32_t headSlot;
+    };
+
+    std::vector<std::uint8_t> ticks;    // ring, one record per tick, oldest at first
+    std::vector<EatRecord> eats;        // ring, one per record that grew
+    size_t first = 0;
+    size_t count = 0;
+    size_t eatFirst = 0;
+    size_t eatCount = 0;
+    std::uint64_t newestTick = 0;       // sim tick the newest record led to
+
+    std::uint8_t& at(size_t i) { return ticks[(first + i) % ticks.size()]; }
+
+public:
+    // Keeps the last capacity ticks
+    explicit RewindBuffer(size_t capacity);
+    // Steps sim and records the tick
+    StepResult step(SnakeSim& sim);
+    // Takes back sim's latest tick. False when it is not recorded (history
+    // used up, or sim was stepped or reset elsewhere since).
+    bool undo(SnakeSim& sim);
+    void clear();
+    size_t size() const { return count; }
+    size_t capacity() const { return ticks.size(); }
+};
@@ -0,0 +1,376 @@
+#include "SimBatch.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__AVX512F__) && defined(__GNUC__) && !defined(__clang__)
+// GCC's AVX-512 headers trip -Wmaybe-uninitialized on their own intrinsics
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+namespace {
+const Direction ALL_DIRECTIONS[4] = { Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT };
+}
+
+size_t SimBatch::vectorWidth() {
+#if defined(__AVX512F__)
+    return 16;
+#elif defined(__AVX2__)
+    return 8;
+#else
+    return 1;
+#endif
+}
+
+const char* SimBatch::backendName() {
+#if defined(__AVX512F__)
+    return "avx512";
+#elif defined(__AVX2__)
+    return "avx2";
+#else
+    return "scalar";
+#endif
+}
+
+SimBatch::SimBatch(int gridWidth, int gridHeight, size_t lanes)
+    : gridWidth(gridWidth)
+    , gridHeight(gridHeight)
+    , stride(gridWidth + 2)
+    , capacity(gridWidth * gridHeight)
+    , wordsPerLane(((gridWidth + 2) * (gridHeight + 2) + 31) / 32) {
+    size_t width = vectorWidth();
+    laneCount = (std::max<size_t>(lanes, 1) + width - 1) / width * width;
+    // Indexed by Direction: UP, DOWN, LEFT, RIGHT
+    offsets[0] = -stride;
+    offsets[1] = stride;
+    offsets[2] = -1;
+    offsets[3] = 1;
+
+    head.assign(laneCount, 0);
+    direction.assign(laneCount, static_cast<std::int32_t>(Direction::RIGHT));
+    fruit.assign(laneCount, 0);
+    length.assign(laneCount, 0);
+    ringHead.assign(laneCount, 0);
+    score.assign(laneCount, 0);
+    alive.assign(laneCount, 0);
+    result.assign(laneCount, static_cast<std::int32_t>(StepResult::MOVED));
+    ticks.assign(laneCount, 0);
+    rngState.assign(laneCount, 0);
+    gameSpeed.assign(laneCount, SnakeSim::BASE_SPEED);
+
+    ring.assign(laneCount * capacity, 0);
+    blocked.assign(laneCount * wordsPerLane, 0);
+    fruitBits.assign(laneCount * wordsPerLane, 0);
+    freeCells.assign(laneCount * capacity, 0);
+    freeSlot.assign(laneCount * capacity, -1);
+    freeCount.assign(laneCount, 0);
+
+    wallTemplate.assign(wordsPerLane, 0);
+    paddedToCell.assign(static_cast<size_t>(stride) * (gridHeight + 2), -1);
+    cellToPadded.assign(capacity, 0);
+    for (int y = 0; y < gridHeight + 2; ++y) {
+        for (int x = 0; x < stride; ++x) {
+            int p = y * stride + x;
+            if (x == 0 || y == 0 || x == stride - 1 || y == gridHeight + 1) {
+                wallTemplate[p >> 5] |= 1u << (p & 31);
+            } else {
+                int cell = (y - 1) * gridWidth + (x - 1);
+                paddedToCell[p] = cell;
+                cellToPadded[cell] = p;
+            }
+        }
+    }
+    laneWordBase.resize(laneCount);
+    for (size_t lane = 0; lane < laneCount; ++lane) {
+        laneWordBase[lane] = static_cast<std::int32_t>(lane * wordsPerLane);
+    }
+    nextHead.assign(laneCount, 0);
+    lastTail.assign(laneCount, 0);
+    hit.assign(laneCount, 0);
+    eat.assign(laneCount, 0);
+}
+
+void SimBatch::freeInsert(size_t lane, std::int32_t cell) {
+    std::int32_t* cells = &freeCells[lane * capacity];
+    std::int32_t* slots = &freeSlot[lane * capacity];
+    if (slots[cell] >= 0) return;
+    cells[freeCount[lane]] = cell;
+    slots[cell] = freeCount[lane]++;
+}
+
+void SimBatch::freeErase(size_t lane, std::int32_t cell) {
+    std::int32_t* cells = &freeCells[lane * capacity];
+    std::int32_t* slots = &freeSlot[lane * capacity];
+    std::int32_t slot = slots[cell];
+    if (slot < 0) return;
+    std::int32_t last = cells[--freeCount[lane]];
+    cells[slot] = last;
+    slots[last] = slot;
+    slots[cell] = -1;
+}
+
+void SimBatch::pushHead(size_t lane, std::int32_t p) {
+    std::int32_t h = ringHead[lane] == 0 ? capacity - 1 : ringHead[lane] - 1;
+    ringHead[lane] = h;
+    ring[lane * capacity + h] = p;
+    ++length[lane];
+    setBit(blocked, lane, p);
+    freeErase(lane, paddedToCell[p]);
+}
+
+void SimBatch::pushTail(size_t lane, std::int32_t p) {
+    std::int32_t slot = ringHead[lane] + length[lane];
+    if (slot >= capacity) slot -= capacity;
+    ring[lane * capacity + slot] = p;
+    ++length[lane];
+    setBit(blocked, lane, p);
+    freeErase(lane, paddedToCell[p]);
+}
+
+bool SimBatch::respawnFruit(size_t lane) {
+    clearBit(fruitBits, lane, fruit[lane]);
+    if (freeCount[lane] == 0) {
+        return false;
+    }
+    SimRng rng(rngState[lane]);
+    std::int32_t cell = freeCells[lane * capacity + rng.below(static_cast<std::uint32_t>(freeCount[lane]))];
+    rngState[lane] = rng.getState();
+    fruit[lane] = cellToPadded[cell];
+    setBit(fruitBits, lane, fruit[lane]);
+    return true;
+}
+
+void SimBatch::reset(size_t lane, std::uint64_t seed) {
+    std::copy(wallTemplate.begin(), wallTemplate.end(), blocked.begin() + lane * wordsPerLane);
+    std::fill(fruitBits.begin() + lane * wordsPerLane, fruitBits.begin() + (lane + 1) * wordsPerLane, 0u);
+    // Same fill order as FreeCellSet::fill() so fruit picks match SnakeSim
+    std::int32_t* cells = &freeCells[lane * capacity];
+    std::int32_t* slots = &freeSlot[lane * capacity];
+    for (std::int32_t i = 0; i < capacity; ++i) {
+        cells[i] = i;
+        slots[i] = i;
+    }
+    freeCount[lane] = capacity;
+    ringHead[lane] = 0;
+    length[lane] = 0;
+    int cx = gridWidth / 2 + 1;
+    int cy = gridHeight / 2 + 1;
+    pushTail(lane, cy * stride + cx);
+    pushTail(lane, cy * stride + cx - 1);
+    pushTail(lane, cy * stride + cx - 2);
+    head[lane] = cy * stride + cx;
+    direction[lane] = static_cast<std::int32_t>(Direction::RIGHT);
+    rngState[lane] = seed;
+    fruit[lane] = 0;
+    respawnFruit(lane);
+    score[lane] = 0;
+    gameSpeed[lane] = SnakeSim::BASE_SPEED;
+    ticks[lane] = 0;
+    alive[lane] = -1;
+    result[lane] = static_cast<std::int32_t>(StepResult::MOVED);
+}
+
+// Applies the anti-reversal rule and computes each live lane's next head.
+void SimBatch::resolveHeads(const std::int32_t* actions) {
+    size_t lane = 0;
+#if defined(__AVX512F__)
+    const __m512i table = _mm512_setr_epi32(offsets[0], offsets[1], offsets[2], offsets[3],
+                                            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    for (; lane + 16 <= laneCount; lane += 16) {
+        __m512i cur = _mm512_loadu_si512(&direction[lane]);
+        __m512i in = _mm512_loadu_si512(actions + lane);
+        __m512i h = _mm512_loadu_si512(&head[lane]);
+        __mmask16 live = _mm512_test_epi32_mask(_mm512_loadu_si512(&alive[lane]), _mm512_set1_epi32(-1));
+        __m512i offIn = _mm512_permutexvar_epi32(in, table);
+        __m512i offCur = _mm512_permutexvar_epi32(cur, table);
+        __mmask16 reverse = _mm512_cmpeq_epi32_mask(_mm512_add_epi32(offIn, offCur), _mm512_setzero_si512());
+        __mmask16 turn = live & ~reverse;
+        __m512i dir = _mm512_mask_blend_epi32(turn, cur, in);
+        __m512i off = _mm512_mask_blend_epi32(turn, offCur, offIn);
+        __m512i next = _mm512_mask_add_epi32(h, live, h, off);
+        _mm512_storeu_si512(&direction[lane], dir);
+        _mm512_storeu_si512(&nextHead[lane], next);
+    }
+#elif defined(__AVX2__)
+    const __m256i table = _mm256_setr_epi32(offsets[0], offsets[1], offsets[2], offsets[3], 0, 0, 0, 0);
+    for (; lane + 8 <= laneCount; lane += 8) {
+        __m256i cur = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&direction[lane]));
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(actions + lane));
+        __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&head[lane]));
+        __m256i live = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&alive[lane]));
+        __m256i offIn = _mm256_permutevar8x32_epi32(table, in);
+        __m256i offCur = _mm256_permutevar8x32_epi32(table, cur);
+        __m256i reverse = _mm256_cmpeq_epi32(_mm256_add_epi32(offIn, offCur), _mm256_setzero_si256());
+        __m256i turn = _mm256_andnot_si256(reverse, live);
+        __m256i dir = _mm256_blendv_epi8(cur, in, turn);
+        __m256i off = _mm256_blendv_epi8(offCur, offIn, turn);
+        __m256i next = _mm256_add_epi32(h, _mm256_and_si256(off, live));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&direction[lane]), dir);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&nextHead[lane]), next);
+    }
+#endif
+    for (; lane < laneCount; ++lane) {
+        if (!alive[lane]) {
+            nextHead[lane] = head[lane];
+            continue;
+        }
+        std::int32_t in = actions[lane];
+        std::int32_t cur = direction[lane];
+        std::int32_t dir = (offsets[in] + offsets[cur] == 0) ? cur : in;
+        direction[lane] = dir;
+        nextHead[lane] = head[lane] + offsets[dir];
+    }
+}
+
+// Masked bit tests of every live lane's next head against its blocked
+// (walls | body) and fruit bitboards.
+void SimBatch::testHeads() {
+    size_t lane = 0;
+#if defined(__AVX512F__)
+    const __m512i lowBits = _mm512_set1_epi32(31);
+    const __m512i one = _mm512_set1_epi32(1);
+    for (; lane + 16 <= laneCount; lane += 16) {
+        __m512i next = _mm512_loadu_si512(&nextHead[lane]);
+        __m512i live = _mm512_loadu_si512(&alive[lane]);
+        __m512i word = _mm512_add_epi32(_mm512_loadu_si512(&laneWordBase[lane]), _mm512_srli_epi32(next, 5));
+        __m512i shift = _mm512_and_si512(next, lowBits);
+        __m512i b = _mm512_i32gather_epi32(word, blocked.data(), 4);
+        __m512i f = _mm512_i32gather_epi32(word, fruitBits.data(), 4);
+        __m512i hitBit = _mm512_and_si512(_mm512_and_si512(_mm512_srlv_epi32(b, shift), one), live);
+        __m512i eatBit = _mm512_and_si512(_mm512_and_si512(_mm512_srlv_epi32(f, shift), one), live);
+        _mm512_storeu_si512(&hit[lane], hitBit);
+        _mm512_storeu_si512(&eat[lane], eatBit);
+    }
+#elif defined(__AVX2__)
+    const __m256i lowBits = _mm256_set1_epi32(31);
+    const __m256i one = _mm256_set1_epi32(1);
+    const int* blockedWords = reinterpret_cast<const int*>(blocked.data());
+    const int* fruitWords = reinterpret_cast<const int*>(fruitBits.data());
+    for (; lane + 8 <= laneCount; lane += 8) {
+        __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&nextHead[lane]));
+        __m256i live = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&alive[lane]));
+        __m256i base = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&laneWordBase[lane]));
+        __m256i word = _mm256_add_epi32(base, _mm256_srli_epi32(next, 5));
+        __m256i shift = _mm256_and_si256(next, lowBits);
+        __m256i b = _mm256_i32gather_epi32(blockedWords, word, 4);
+        __m256i f = _mm256_i32gather_epi32(fruitWords, word, 4);
+        __m256i hitBit = _mm256_and_si256(_mm256_and_si256(_mm256_srlv_epi32(b, shift), one), live);
+        __m256i eatBit = _mm256_and_si256(_mm256_and_si256(_mm256_srlv_epi32(f, shift), one), live);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&hit[lane]), hitBit);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&eat[lane]), eatBit);
+    }
+#endif
+    for (; lane < laneCount; ++lane) {
+        hit[lane] = alive[lane] && testBit(blocked, lane, nextHead[lane]);
+        eat[lane] = alive[lane] && testBit(fruitBits, lane, nextHead[lane]);
+    }
+}
+
+void SimBatch::step(const std::int32_t* actions) {
+    resolveHeads(actions);
+
+    // Vacate tails first so a head may follow its tail into the freed cell
+    for (size_t lane = 0; lane < laneCount; ++lane) {
+        if (!alive[lane]) continue;
+        std::int32_t slot = ringHead[lane] + length[lane] - 1;
+        if (slot >= capacity) slot -= capacity;
+        std::int32_t tail = ring[lane * capacity + slot];
+        lastTail[lane] = tail;
+        --length[lane];
+        clearBit(blocked, lane, tail);
+        freeInsert(lane, paddedToCell[tail]);
+    }
+
+    testHeads();
+
+    for (size_t lane = 0; lane < laneCount; ++lane) {
+        if (!alive[lane]) continue;
+        ++ticks[lane];
+        std::int32_t next = nextHead[lane];
+        head[lane] = next;
+        if (hit[lane]) {
+            // Keep the dead head in the ring, like SnakeSim, but leave the
+            // bitboards alone.
+            std::int32_t h = ringHead[lane] == 0 ? capacity - 1 : ringHead[lane] - 1;
+            ringHead[lane] = h;
+            ring[lane * capacity + h] = next;
+            ++length[lane];
+            alive[lane] = 0;
+            result[lane] = static_cast<std::int32_t>(paddedToCell[next] < 0 ? StepResult::HIT_WALL : StepResult::HIT_SELF);
+            continue;
+        }
+        pushHead(lane, next);
+        if (!eat[lane]) {
+            result[lane] = static_cast<std::int32_t>(StepResult::MOVED);
+            continue;
+        }
+        pushTail(lane, lastTail[lane]);
+        score[lane] += SnakeSim::FRUIT_SCORE;
+        if (gameSpeed[lane] > SnakeSim::MIN_SPEED) {
+            gameSpeed[lane] -= SnakeSim::SPEED_INCREASE;
+        }
+        if (respawnFruit(lane)) {
+            result[lane] = static_cast<std::int32_t>(StepResult::ATE);
+        } else {
+            alive[lane] = 0;
+            result[lane] = static_cast<std::int32_t>(StepResult::WON);
+        }
+    }
+}
+
+Position SimBatch::getSegment(size_t lane, size_t i) const {
+    std::int32_t p = getSegmentCell(lane, i);
+    return Position(p % stride - 1, p / stride - 1);
+}
+
+std::int32_t SimBatch::getSegmentCell(size_t lane, size_t i) const {
+    std::int32_t slot = ringHead[lane] + static_cast<std::int32_t>(i);
+    if (slot >= capacity) slot -= capacity;
+    return ring[lane * capacity + slot];
+}
+
+bool SimBatch::isSafeMove(size_t lane, Direction dir) const {
+    std::int32_t d = static_cast<std::int32_t>(dir);
+    if (offsets[d] + offsets[direction[lane]] == 0) {
+        return false;
+    }
+    std::int32_t next = head[lane] + offsets[d];
+    std::int32_t slot = ringHead[lane] + length[lane] - 1;
+    if (slot >= capacity) slot -= capacity;
+    return !testBit(blocked, lane, next) || next == ring[lane * capacity + slot];
+}
+
+Direction SimBatch::chooseGreedy(size_t lane, SimRng& rng) const {
+    static const int DX[4] = { 0, 0, -1, 1 };
+    static const int DY[4] = { -1, 1, 0, 0 };
+    const std::int32_t h = head[lane];
+    const int hx = h % stride;
+    const int hy = h / stride;
+    const int fx = fruit[lane] % stride;
+    const int fy = fruit[lane] / stride;
+    std::int32_t slot = ringHead[lane] + length[lane] - 1;
+    if (slot >= capacity) slot -= capacity;
+    const std::int32_t tail = ring[lane * capacity + slot];
+    const std::int32_t reverse = -offsets[direction[lane]];
+
+    Direction options[4];
+    std::uint32_t count = 0;
+    int bestDistance = 0;
+    for (int d = 0; d < 4; ++d) {
+        std::int32_t next = h + offsets[d];
+        // Inlined isSafeMove()
+        if (offsets[d] == reverse || (testBit(blocked, lane, next) && next != tail)) continue;
+        int distance = std::abs(hx + DX[d] - fx) + std::abs(hy + DY[d] - fy);
+        if (count == 0 || distance < bestDistance) {
+            bestDistance = distance;
+            count = 0;
+        } else if (distance > bestDistance) {
+            continue;
+        }
+        options[count++] = ALL_DIRECTIONS[d];
+    }
+    if (count == 0) return static_cast<Direction>(direction[lane]);
+    return options[count == 1 ? 0 : rng.below(count)];
+}
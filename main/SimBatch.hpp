@@ -0,0 +1,116 @@
+#pragma once
+
+// Structure-of-arrays backend that advances many independent games in lock
+// step. Each lane is one game with the same rules and RNG stream as
+// SnakeSim, so a lane seeded and driven like a SnakeSim produces the same
+// game.
+//
+// The board uses a padded (width + 2) x (height + 2) layout whose border is
+// pre-set in a per-lane "blocked" bitboard, so the wall bounds check and the
+// self-collision lookup are one masked bit test. Direction resolution, head
+// advance and the blocked/fruit bit tests run across lanes with AVX-512
+// (16 lanes) or AVX2 (8 lanes) when compiled with those ISAs, falling back
+// to scalar code otherwise. Ring-buffer, bitboard and free-cell updates are
+// per-lane scatters and stay scalar.
+
+#include "SnakeSim.hpp"
+#include <cstdint>
+#include <vector>
+
+class SimBatch {
+private:
+    int gridWidth;
+    int gridHeight;
+    int stride;             // padded row length (gridWidth + 2)
+    int capacity;           // gridWidth * gridHeight, ring size per lane
+    int wordsPerLane;       // 32-bit words per padded bitboard
+    size_t laneCount;       // rounded up to a multiple of vectorWidth()
+    std::int32_t offsets[4];
+
+    // Per-lane state, indexed by lane
+    std::vector<std::int32_t> head;         // padded cell index
+    std::vector<std::int32_t> direction;    // Direction as int
+    std::vector<std::int32_t> fruit;        // padded cell index
+    std::vector<std::int32_t> length;
+    std::vector<std::int32_t> ringHead;
+    std::vector<std::int32_t> score;
+    std::vector<std::int32_t> alive;        // -1 alive, 0 finished (vector mask)
+    std::vector<std::int32_t> result;       // StepResult of the last step
+    std::vector<std::uint64_t> ticks;
+    std::vector<std::uint64_t> rngState;
+    std::vector<float> gameSpeed;
+
+    // Per-lane blocks, lane-major
+    std::vector<std::int32_t> ring;         // capacity per lane, padded indices
+    std::vector<std::uint32_t> blocked;     // walls | body
+    std::vector<std::uint32_t> fruitBits;
+    std::vector<std::int32_t> freeCells;    // capacity per lane, grid indices
+    std::vector<std::int32_t> freeSlot;     // capacity per lane
+    std::vector<std::int32_t> freeCount;
+
+    // Shared lookup tables and per-step scratch
+    std::vector<std::uint32_t> wallTemplate;
+    std::vector<std::int32_t> paddedToCell; // -1 for border cells
+    std::vector<std::int32_t> cellToPadded;
+    std::vector<std::int32_t> laneWordBase; // lane * wordsPerLane
+    std::vector<std::int32_t> nextHead;
+    std::vector<std::int32_t> lastTail;
+    std::vector<std::int32_t> hit;
+    std::vector<std::int32_t> eat;
+
+    bool testBit(const std::vector<std::uint32_t>& bits, size_t lane, std::int32_t p) const {
+        return (bits[lane * wordsPerLane + (p >> 5)] >> (p & 31)) & 1u;
+    }
+    void setBit(std::vector<std::uint32_t>& bits, size_t lane, std::int32_t p) {
+        bits[lane * wordsPerLane + (p >> 5)] |= 1u << (p & 31);
+    }
+    void clearBit(std::vector<std::uint32_t>& bits, size_t lane, std::int32_t p) {
+        bits[lane * wordsPerLane + (p >> 5)] &= ~(1u << (p & 31));
+    }
+    void freeInsert(size_t lane, std::int32_t cell);
+    void freeErase(size_t lane, std::int32_t cell);
+    void pushHead(size_t lane, std::int32_t p);
+    void pushTail(size_t lane, std::int32_t p);
+    bool respawnFruit(size_t lane);
+
+    void resolveHeads(const std::int32_t* actions);
+    void testHeads();
+
+public:
+    SimBatch(int gridWidth, int gridHeight, size_t lanes);
+
+    // Lanes processed per vector instruction in this build (16, 8 or 1)
+    static size_t vectorWidth();
+    static const char* backendName();
+
+    size_t getLaneCount() const { return laneCount; }
+    int getGridWidth() const { return gridWidth; }
+    int getGridHeight() const { return gridHeight; }
+
+    void reset(size_t lane, std::uint64_t seed);
+    // Removes a lane from play without touching its state.
+    void retire(size_t lane) { alive[lane] = 0; }
+    // Advances every live lane by one tick. actions[lane] is a Direction
+    // value (0..3); reversals are ignored exactly as in Snake::setDirection().
+    void step(const std::int32_t* actions);
+
+    bool isAlive(size_t lane) const { return alive[lane] != 0; }
+    StepResult getLastResult(size_t lane) const { return static_cast<StepResult>(result[lane]); }
+    int getScore(size_t lane) const { return score[lane]; }
+    float getGameSpeed(size_t lane) const { return gameSpeed[lane]; }
+    std::uint64_t getTicks(size_t lane) const { return ticks[lane]; }
+    size_t getLength(size_t lane) const { return static_cast<size_t>(length[lane]); }
+    Direction getDirection(size_t lane) const { return static_cast<Direction>(direction[lane]); }
+    Position getHead(size_t lane) const { return Position(head[lane] % stride - 1, head[lane] / stride - 1); }
+    Position getFruit(size_t lane) const { return Position(fruit[lane] % stride - 1, fruit[lane] / stride - 1); }
+    // Body cell i (0 = head) of a lane, in grid coordinates
+    Position getSegment(size_t lane, size_t i) const;
+    // The same as padded indices, (y + 1) * (gridWidth + 2) + x + 1
+    std::int32_t getHeadCell(size_t lane) const { return head[lane]; }
+    std::int32_t getFruitCell(size_t lane) const { return fruit[lane]; }
+    std::int32_t getSegmentCell(size_t lane, size_t i) const;
+
+    // Same decision rule and RNG use as isSafeMove() / GreedyBot::choose()
+    bool isSafeMove(size_t lane, Direction dir) const;
+    Direction chooseGreedy(size_t lane, SimRng& rng) const;
+};
@@ -0,0 +1,236 @@
+#include "SnakeEnv.h"
+#include "SimBatch.hpp"
+#include "PhasePool.hpp"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+enum Plane { HEAD, BODY, FRUIT, WALLS };
+
+const int MIN_SIDE = 8;
+const int MAX_SIDE = 4096;
+
+// Games [first, first + count), stepped by one SimBatch on one thread.
+// head, tail and fruit are the padded cells last written to each game's
+// observation, so a step knows which to clear.
+struct Shard {
+    std::size_t first;
+    std::size_t count;
+    SimBatch batch;
+    std::vector<std::int32_t> actions;  // one per SimBatch lane; padding lanes stay 0
+    std::vector<std::int32_t> head;
+    std::vector<std::int32_t> tail;
+    std::vector<std::int32_t> fruit;
+    std::vector<std::uint64_t> seed;    // of each game's current episode
+    SnakeEnvStats stats{};
+
+    Shard(int width, int height, std::size_t first, std::size_t count)
+        : first(first)
+        , count(count)
+        , batch(width, height, count)
+        , actions(batch.getLaneCount(), 0)
+        , head(count)
+        , tail(count)
+        , fruit(count)
+        , seed(count) {}
+};
+
+} // namespace
+
+struct SnakeEnv {
+    int width;
+    int height;
+    std::size_t planeSize;      // (width + 2) * (height + 2)
+    PhasePool pool;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::size_t gameCount = 0;
+    std::uint8_t* observations = nullptr;
+    float* rewards = nullptr;
+    std::uint8_t* dones = nullptr;
+    const std::int32_t* actions = nullptr;
+
+    SnakeEnv(int width, int height, unsigned threads)
+        : width(width)
+        , height(height)
+        , planeSize(static_cast<std::size_t>(width + 2) * (height + 2))
+        , pool(threads) {}
+
+    std::size_t observationSize() const { return planeSize * SNAKE_ENV_PLANES; }
+    std::uint8_t* observation(const Shard& s, std::size_t lane) const {
+        return observations + (s.first + lane) * observationSize();
+    }
+    void restart(Shard& s, std::size_t lane);
+    void step(Shard& s);
+};
+
+// Starts lane's game from its seed and draws it from scratch; the walls
+// plane never changes
+void SnakeEnv::restart(Shard& s, std::size_t lane) {
+    SimBatch& batch = s.batch;
+    batch.reset(lane, s.seed[lane]);
+    std::uint8_t* obs = observation(s, lane);
+    std::memset(obs, 0, planeSize * WALLS);
+    for (std::size_t i = 0; i < batch.getLength(lane); ++i) {
+        obs[planeSize * BODY + batch.getSegmentCell(lane, i)] = 1;
+    }
+    s.head[lane] = batch.getHeadCell(lane);
+    s.tail[lane] = batch.getSegmentCell(lane, batch.getLength(lane) - 1);
+    s.fruit[lane] = batch.getFruitCell(lane);
+    obs[planeSize * HEAD + s.head[lane]] = 1;
+    obs[planeSize * FRUIT + s.fruit[lane]] = 1;
+}
+
+void SnakeEnv::step(Shard& s) {
+    std::copy(actions + s.first, actions + s.first + s.count, s.actions.begin());
+    SimBatch& batch = s.batch;
+    batch.step(s.actions.data());
+    s.stats.steps += s.count;
+    for (std::size_t lane = 0; lane < s.count; ++lane) {
+        std::uint8_t* obs = observation(s, lane);
+        const std::size_t game = s.first + lane;
+        const StepResult result = batch.getLastResult(lane);
+        if (result != StepResult::MOVED && result != StepResult::ATE) {
+            rewards[game] = result == StepResult::WON ? static_cast<float>(SnakeSim::FRUIT_SCORE) : 0.f;
+            dones[game] = 1;
+            ++s.stats.episodes;
+            if (result == StepResult::WON) {
+                ++s.stats.wins;
+                ++s.stats.fruits;
+            }
+            s.seed[lane] = SimRng(s.seed[lane]).next();
+            restart(s, lane);
+            continue;
+        }
+        dones[game] = 0;
+        const std::int32_t head = batch.getHeadCell(lane);
+        obs[planeSize * HEAD + s.head[lane]] = 0;
+        obs[planeSize * HEAD + head] = 1;
+        s.head[lane] = head;
+        if (result == StepResult::MOVED) {
+            // Cleared before the head is drawn, which may have moved into it
+            obs[planeSize * BODY + s.tail[lane]] = 0;
+            s.tail[lane] = batch.getSegmentCell(lane, batch.getLength(lane) - 1);
+            obs[planeSize * BODY + head] = 1;
+            rewards[game] = 0.f;
+            continue;
+        }
+        obs[planeSize * BODY + head] = 1;
+        obs[planeSize * FRUIT + s.fruit[lane]] = 0;
+        s.fruit[lane] = batch.getFruitCell(lane);
+        obs[planeSize * FRUIT + s.fruit[lane]] = 1;
+        rewards[game] = static_cast<float>(SnakeSim::FRUIT_SCORE);
+        ++s.stats.fruits;
+    }
+}
+
+SnakeEnv* snake_env_create(int width, int height, int threads) {
+    if (width < MIN_SIDE || height < MIN_SIDE || width > MAX_SIDE || height > MAX_SIDE || threads < 0) {
+        return nullptr;
+    }
+    const unsigned count = threads > 0 ? static_cast<unsigned>(threads) : std::max(1u, std::thread::hardware_concurrency());
+    // The pool's threads may fail to start as well as the allocation
+    try {
+        return new SnakeEnv(width, height, count);
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+void snake_env_destroy(SnakeEnv* env) {
+    delete env;
+}
+
+size_t snake_env_observation_size(const SnakeEnv* env) {
+    return env ? env->observationSize() : 0;
+}
+
+int snake_env_reset(SnakeEnv* env, size_t n, const uint64_t* seeds, uint8_t* observations, float* rewards,
+                    uint8_t* dones) {
+    if (!env || n == 0 || !observations || !rewards || !dones) {
+        return -1;
+    }
+    // Nothing may throw across the C boundary into the host
+    try {
+        if (n != env->gameCount) {
+            // The only allocation: one shard per thread, or per game when fewer
+            const std::size_t shardCount = std::min<std::size_t>(env->pool.size(), n);
+            env->shards.clear();
+            env->gameCount = 0;
+            for (std::size_t i = 0; i < shardCount; ++i) {
+                const std::size_t first = n * i / shardCount;
+                const std::size_t last = n * (i + 1) / shardCount;
+                env->shards.push_back(std::make_unique<Shard>(env->width, env->height, first, last - first));
+            }
+            env->gameCount = n;
+        }
+        env->observations = observations;
+        env->rewards = rewards;
+        env->dones = dones;
+
+        // The walls plane is written once here
+        std::vector<std::uint8_t> walls(env->planeSize, 1);
+        for (int y = 1; y <= env->height; ++y) {
+            std::memset(&walls[static_cast<std::size_t>(y) * (env->width + 2) + 1], 0, static_cast<std::size_t>(env->width));
+        }
+        for (auto& shard : env->shards) {
+            Shard& s = *shard;
+            s.stats = SnakeEnvStats{};
+            for (std::size_t lane = 0; lane < s.count; ++lane) {
+                const std::size_t game = s.first + lane;
+                s.seed[lane] = seeds ? seeds[game] : game;
+                env->restart(s, lane);
+                std::memcpy(env->observation(s, lane) + env->planeSize * WALLS, walls.data(), env->planeSize);
+                rewards[game] = 0.f;
+                dones[game] = 0;
+            }
+        }
+    } catch (const std::exception&) {
+        // Out of memory: leave the handle unbound, so steps fail until a
+        // reset succeeds
+        env->shards.clear();
+        env->gameCount = 0;
+        env->observations = nullptr;
+        env->rewards = nullptr;
+        env->dones = nullptr;
+        return -1;
+    }
+    return 0;
+}
+
+int snake_env_step(SnakeEnv* env, const int32_t* actions) {
+    if (!env || !env->observations || !actions) {
+        return -1;
+    }
+    // SimBatch indexes a table by action, so anything but a Direction
+    // would read past it
+    for (std::size_t i = 0; i < env->gameCount; ++i) {
+        if (static_cast<std::uint32_t>(actions[i]) > static_cast<std::uint32_t>(Direction::RIGHT)) return -1;
+    }
+    env->actions = actions;
+    auto stepShards = [env](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) env->step(*env->shards[i]);
+    };
+    env->pool.run(env->shards.size(), stepShards);
+    return 0;
+}
+
+void snake_env_get_stats(const SnakeEnv* env, SnakeEnvStats* stats) {
+    if (!stats) {
+        return;
+    }
+    *stats = SnakeEnvStats{};
+    if (!env) {
+        return;
+    }
+    for (const auto& shard : env->shards) {
+        stats->steps += shard->stats.steps;
+        stats->episodes += shard->stats.episodes;
+        stats->wins += shard->stats.wins;
+        stats->fruits += shard->stats.fruits;
+    }
+}
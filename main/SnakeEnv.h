@@ -0,0 +1,77 @@
+#pragma once
+
+// C interface to a vectorized snake environment for reinforcement learning
+// (libsnakeenv). One handle runs N independent games with the rules of
+// SnakeSim, split into one contiguous shard per thread, each shard stepped
+// lane-parallel by SimBatch. Nothing is allocated after snake_env_reset().
+//
+// Observations go straight into one caller-owned buffer of
+// N * snake_env_observation_size() bytes. Per game there are
+// SNAKE_ENV_PLANES planes of (height + 2) x (width + 2) bytes, row-major,
+// 1 where the plane's feature is and 0 elsewhere:
+//
+//   plane 0  head
+//   plane 1  body, head included
+//   plane 2  fruit
+//   plane 3  walls: the one-cell border, the board being rows and
+//            columns 1..height and 1..width
+//
+// A step rewrites only the cells that changed, so the caller must leave
+// the buffer alone between calls. Rewards (float) and done flags (uint8_t)
+// are one per game.
+//
+// Actions are Direction values: 0 up, 1 down, 2 left, 3 right; a reversal
+// is ignored, as in play. A step with any other action is rejected whole.
+// A step's reward is the score it added (10 per fruit, as the HUD counts).
+// A game that ends, against a wall or the body or by filling the board,
+// sets its done flag and restarts in the same step, so its observation is
+// already the new game's first. Each new game is seeded with splitmix64 of
+// the seed of the one before.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define SNAKE_ENV_API __declspec(dllexport)
+#else
+#define SNAKE_ENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNAKE_ENV_PLANES 4
+
+typedef struct SnakeEnv SnakeEnv;
+
+typedef struct SnakeEnvStats {
+    uint64_t steps;     // game steps, summed over games
+    uint64_t episodes;  // games ended
+    uint64_t wins;      // of which filled the board
+    uint64_t fruits;
+} SnakeEnvStats;
+
+// width x height boards (8..4096 cells a side). threads includes the
+// caller; 0 uses every core. NULL on bad arguments or when out of memory.
+SNAKE_ENV_API SnakeEnv* snake_env_create(int width, int height, int threads);
+SNAKE_ENV_API void snake_env_destroy(SnakeEnv* env);
+// Bytes of observation per game
+SNAKE_ENV_API size_t snake_env_observation_size(const SnakeEnv* env);
+// Starts n games, game i seeded with seeds[i] (or i when seeds is NULL),
+// and binds the buffers every later step writes into: observations of
+// n * snake_env_observation_size() bytes, n rewards and n done flags.
+// Returns 0, or -1 on bad arguments or when out of memory; after a failed
+// reset steps fail until a reset succeeds.
+SNAKE_ENV_API int snake_env_reset(SnakeEnv* env, size_t n, const uint64_t* seeds, uint8_t* observations,
+                                  float* rewards, uint8_t* dones);
+// Advances every game one tick with actions[i] (0..3) for game i. Returns
+// 0, or -1 without stepping any game on bad arguments, before the first
+// reset or when an action is out of range.
+SNAKE_ENV_API int snake_env_step(SnakeEnv* env, const int32_t* actions);
+// Totals since the last reset
+SNAKE_ENV_API void snake_env_get_stats(const SnakeEnv* env, SnakeEnvStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,300 @@
+#include "SnakeSim.hpp"
+
+// FreeCellSet Implementation
+FreeCellSet::FreeCellSet(size_t cellCount) : cells(cellCount), slotOf(cellCount, -1) {
+    fill();
+}
+
+void FreeCellSet::fill() {
+    for (size_t i = 0; i < cells.size(); ++i) {
+        cells[i] = static_cast<int>(i);
+        slotOf[i] = static_cast<int>(i);
+    }
+    count = cells.size();
+}
+
+void FreeCellSet::insert(int cell) {
+    if (slotOf[cell] >= 0) return;
+    cells[count] = cell;
+    slotOf[cell] = static_cast<int>(count);
+    ++count;
+}
+
+void FreeCellSet::erase(int cell) {
+    int slot = slotOf[cell];
+    if (slot < 0) return;
+    // Move the last free cell into the vacated slot
+    int last = cells[--count];
+    cells[slot] = last;
+    slotOf[last] = slot;
+    slotOf[cell] = -1;
+}
+
+void FreeCellSet::insertAt(int cell, size_t slot) {
+    if (slot < count) {
+        int moved = cells[slot];
+        cells[count] = moved;
+        slotOf[moved] = static_cast<int>(count);
+    }
+    cells[slot] = cell;
+    slotOf[cell] = static_cast<int>(slot);
+    ++count;
+}
+
+// Snake Implementation
+Snake::Snake(int gridWidth, int gridHeight)
+    : gridWidth(gridWidth)
+    , gridHeight(gridHeight)
+    , ring(static_cast<size_t>(gridWidth) * gridHeight)
+    , occupied(static_cast<size_t>(gridWidth) * gridHeight)
+    , freeCells(static_cast<size_t>(gridWidth) * gridHeight)
+    , direction(Direction::RIGHT)
+    , nextDirection(Direction::RIGHT) {
+    reset();
+}
+
+void Snake::reset() {
+    occupied.clear();
+    freeCells.fill();
+    headIndex = 0;
+    length = 0;
+    selfCollision = false;
+    // Center of grid, facing right
+    int cx = gridWidth / 2;
+    int cy = gridHeight / 2;
+    pushTail(Position(cx, cy));
+    pushTail(Position(cx - 1, cy));
+    pushTail(Position(cx - 2, cy));
+    lastTail = Position(cx - 3, cy);
+    direction = Direction::RIGHT;
+    nextDirection = Direction::RIGHT;
+}
+
+void Snake::pushHead(const Position& pos) {
+    headIndex = (headIndex == 0) ? ring.size() - 1 : headIndex - 1;
+    ring[headIndex] = pos;
+    ++length;
+    if (inBounds(pos)) {
+        occupied.set(cellIndex(pos));
+        freeCells.erase(static_cast<int>(cellIndex(pos)));
+    }
+}
+
+void Snake::pushTail(const Position& pos) {
+    size_t slot = headIndex + length;
+    if (slot >= ring.size()) slot -= ring.size();
+    ring[slot] = pos;
+    ++length;
+    if (inBounds(pos)) {
+        occupied.set(cellIndex(pos));
+        freeCells.erase(static_cast<int>(cellIndex(pos)));
+    }
+}
+
+Position Snake::popTail() {
+    size_t slot = headIndex + length - 1;
+    if (slot >= ring.size()) slot -= ring.size();
+    Position tail = ring[slot];
+    --length;
+    if (inBounds(tail)) {
+        occupied.reset(cellIndex(tail));
+        freeCells.insert(static_cast<int>(cellIndex(tail)));
+    }
+    return tail;
+}
+
+void Snake::move() {
+    direction = nextDirection;
+    
+    Position newHead = getHead() + directionVector(direction);
+    // Vacate the tail first so the head may follow it into the freed cell
+    lastTail = popTail();
+    selfCollision = inBounds(newHead) && occupied.test(cellIndex(newHead));
+    pushHead(newHead);
+}
+
+void Snake::grow() {
+    // Keep the tail that the last move() dropped
+    pushTail(lastTail);
+}
+
+void Snake::unmove(const StepUndo& undo) {
+    const Position head = getHead();
+    size_t headSlot = undo.headSlot;
+    if (!undo.grew) {
+        // Erasing the head moved the just-freed tail into the head's slot,
+        // unless the head took that very cell
+        headSlot = head == undo.tail ? freeCells.size()
+                                     : static_cast<size_t>(freeCells.slot(static_cast<int>(cellIndex(undo.tail))));
+    }
+    headIndex = (headIndex + 1 == ring.size()) ? 0 : headIndex + 1;
+    --length;
+    // A head that ran into the body shares that cell, which stays taken
+    if (inBounds(head) && !selfCollision) {
+        occupied.reset(cellIndex(head));
+        freeCells.insertAt(static_cast<int>(cellIndex(head)), headSlot);
+    }
+    if (!undo.grew) {
+        pushTail(undo.tail);
+    }
+    lastTail = undo.lastTail;
+    selfCollision = false;
+    direction = undo.direction;
+    nextDirection = undo.direction;
+}
+
+void Snake::setDirection(Direction dir) {
+    // Prevent 180-degree turns
+    bool canChangeDirection = false;
+    switch (dir) {
+        case Direction::UP:    canChangeDirection = (direction != Direction::DOWN); break;
+        case Direction::DOWN:  canChangeDirection = (direction != Direction::UP); break;
+        case Direction::LEFT:  canChangeDirection = (direction != Direction::RIGHT); break;
+        case Direction::RIGHT: canChangeDirection = (direction != Direction::LEFT); break;
+    }
+    
+    if (canChangeDirection) {
+        nextDirection = dir;
+    }
+}
+
+// Fruit Implementation
+bool Fruit::respawn(const Snake& snake) {
+    const FreeCellSet& freeCells = snake.getFreeCells();
+    if (freeCells.empty()) {
+        return false;
+    }
+    int cell = freeCells.at(rng.below(static_cast<std::uint32_t>(freeCells.size())));
+    position = Position(cell % snake.getGridWidth(), cell / snake.getGridWidth());
+    return true;
+}
+
+// InputQueue Implementation
+bool InputQueue::push(Direction dir, Direction current) {
+    Direction last = count ? items[(first + count - 1) % CAPACITY] : current;
+    if (dir == last) {
+        ++stats.coalesced;
+        return false;
+    }
+    if (isOpposite(dir, last) || count == CAPACITY) {
+        ++stats.dropped;
+        return false;
+    }
+    items[(first + count) % CAPACITY] = dir;
+    ++count;
+    return true;
+}
+
+bool InputQueue::pop(Direction& dir) {
+    if (count == 0) {
+        return false;
+    }
+    dir = items[first];
+    first = (first + 1) % CAPACITY;
+    --count;
+    ++stats.applied;
+    return true;
+}
+
+// SnakeSim Implementation
+SnakeSim::SnakeSim(int gridWidth, int gridHeight, std::uint64_t seed)
+    : gridWidth(gridWidth)
+    , gridHeight(gridHeight)
+    , snake(gridWidth, gridHeight)
+    , fruit(seed) {
+    reset(seed);
+}
+
+void SnakeSim::reset(std::uint64_t newSeed) {
+    seed = newSeed;
+    snake.reset();
+    fruit.reseed(newSeed);
+    fruit.respawn(snake);
+    inputs.clear();
+    inputs.resetStats();
+    ticks = 0;
+    score = 0;
+    gameSpeed = BASE_SPEED;
+    over = false;
+    outcome = StepResult::MOVED;
+}
+
+StepResult SnakeSim::advance(StepUndo* undo) {
+    if (over) {
+        return outcome;
+    }
+    const FreeCellSet& freeCells = snake.getFreeCells();
+    int lastFree = -1;
+    if (undo) {
+        undo->direction = snake.getDirection();
+        undo->tail = snake.getBody().back();
+        undo->lastTail = snake.getLastTail();
+        undo->grew = false;
+        undo->sped = false;
+        undo->fruitRng = fruit.getRngState();
+        lastFree = freeCells.empty() ? -1 : freeCells.at(freeCells.size() - 1);
+    }
+    ++ticks;
+    Direction turn;
+    if (inputs.pop(turn)) {
+        snake.setDirection(turn);
+    }
+    snake.move();
+    
+    // Check wall collision
+    const Position& head = snake.getHead();
+    if (!isValidPosition(head)) {
+        over = true;
+        return outcome = StepResult::HIT_WALL;
+    }
+    
+    // Check self collision
+    if (snake.checkSelfCollision()) {
+        over = true;
+        return outcome = StepResult::HIT_SELF;
+    }
+    
+    // Check fruit collision
+    if (head == fruit.getPosition()) {
+        snake.grow();
+        if (undo) {
+            // Net of the tick, the head's cell was erased from the free set,
+            // which moved the last free cell into its slot
+            const int headCell = head.y * gridWidth + head.x;
+            undo->grew = true;
+            undo->sped = gameSpeed > MIN_SPEED;
+            undo->headSlot = static_cast<std::uint32_t>(lastFree == headCell ? freeCells.size() : freeCells.slot(lastFree));
+        }
+        score += FRUIT_SCORE;
+        // Increase speed slightly with each fruit eaten
+        if (gameSpeed > MIN_SPEED) {
+            gameSpeed -= SPEED_INCREASE;
+        }
+        if (!fruit.respawn(snake)) {
+            // Board is full: nothing left to eat
+            over = true;
+            return outcome = StepResult::WON;
+        }
+        return StepResult::ATE;
+    }
+    return StepResult::MOVED;
+}
+
+void SnakeSim::unstep(const StepUndo& undo) {
+    if (ticks == 0) {
+        return;
+    }
+    if (undo.grew) {
+        // The fruit was eaten where the head is now
+        fruit.restore(snake.getHead(), undo.fruitRng);
+        score -= FRUIT_SCORE;
+        if (undo.sped) {
+            gameSpeed += SPEED_INCREASE;
+        }
+    }
+    snake.unmove(undo);
+    inputs.clear();
+    --ticks;
+    over = false;
+    outcome = StepResult::MOVED;
+}
@@ -0,0 +1,392 @@
+#pragma once
+
+// Rendering-free snake simulation: board state, rules, scoring and a
+// seedable RNG. Nothing in here depends on SFML, so it can be stepped
+// headless (batch runs, tools, servers) as fast as the CPU allows.
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+
+enum class Direction {
+    UP,
+    DOWN,
+    LEFT,
+    RIGHT
+};
+
+struct Position {
+    int x, y;
+    
+    Position(int x = 0, int y = 0) : x(x), y(y) {}
+    
+    bool operator==(const Position& other) const {
+        return x == other.x && y == other.y;
+    }
+    
+    Position operator+(const Position& other) const {
+        return Position(x + other.x, y + other.y);
+    }
+};
+
+inline Position directionVector(Direction dir) {
+    switch (dir) {
+        case Direction::UP:    return Position(0, -1);
+        case Direction::DOWN:  return Position(0, 1);
+        case Direction::LEFT:  return Position(-1, 0);
+        case Direction::RIGHT: return Position(1, 0);
+    }
+    return Position(0, 0);
+}
+
+inline bool isOpposite(Direction a, Direction b) {
+    return directionVector(a) + directionVector(b) == Position(0, 0);
+}
+
+// What one SnakeSim::step() overwrote, so unstep() can put the game back
+// exactly as it was, down to the order of the free-cell set that fruit
+// placement draws from.
+struct StepUndo {
+    Direction direction = Direction::RIGHT; // heading before the tick
+    Position tail;                  // cell the tail left (kept when grew)
+    Position lastTail;              // Snake::getLastTail() before the tick
+    bool grew = false;              // ate: the tail stayed and the fruit moved
+    bool sped = false;              // eating lowered gameSpeed
+    std::uint64_t fruitRng = 0;     // fruit RNG state before the respawn
+    std::uint32_t headSlot = 0;     // free-cell slot the head was taken from, when grew
+};
+
+// Read-only view over the snake's ring buffer, ordered head to tail.
+class SnakeBody {
+private:
+    const Position* cells = nullptr;
+    size_t capacity = 0;
+    size_t headIndex = 0;
+    size_t length = 0;
+
+public:
+    // Holds the ring itself rather than the view, so it stays valid after a
+    // temporary SnakeBody it came from is gone
+    class const_iterator {
+    private:
+        const Position* cells = nullptr;
+        size_t capacity = 0;
+        size_t headIndex = 0;
+        size_t index = 0;
+
+        const Position& at(size_t i) const {
+            size_t slot = headIndex + i;
+            if (slot >= capacity) slot -= capacity;
+            return cells[slot];
+        }
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Position;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Position*;
+        using reference = const Position&;
+
+        const_iterator() = default;
+        const_iterator(const Position* cells, size_t capacity, size_t headIndex, size_t index)
+            : cells(cells), capacity(capacity), headIndex(headIndex), index(index) {}
+
+        reference operator*() const { return at(index); }
+        pointer operator->() const { return &at(index); }
+        reference operator[](difference_type n) const { return at(index + n); }
+        const_iterator& operator++() { ++index; return *this; }
+        const_iterator operator++(int) { const_iterator tmp = *this; ++index; return tmp; }
+        const_iterator& operator--() { --index; return *this; }
+        const_iterator operator--(int) { const_iterator tmp = *this; --index; return tmp; }
+        const_iterator& operator+=(difference_type n) { index += n; return *this; }
+        const_iterator& operator-=(difference_type n) { index -= n; return *this; }
+        const_iterator operator+(difference_type n) const { return const_iterator(cells, capacity, headIndex, index + n); }
+        const_iterator operator-(difference_type n) const { return const_iterator(cells, capacity, headIndex, index - n); }
+        difference_type operator-(const const_iterator& other) const {
+            return static_cast<difference_type>(index) - static_cast<difference_type>(other.index);
+        }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+        bool operator<(const const_iterator& other) const { return index < other.index; }
+        bool operator>(const const_iterator& other) const { return index > other.index; }
+        bool operator<=(const const_iterator& other) const { return index <= other.index; }
+        bool operator>=(const const_iterator& other) const { return index >= other.index; }
+    };
+
+    SnakeBody() = default;
+    SnakeBody(const Position* cells, size_t capacity, size_t headIndex, size_t length)
+        : cells(cells), capacity(capacity), headIndex(headIndex), length(length) {}
+
+    const Position& operator[](size_t i) const {
+        size_t slot = headIndex + i;
+        if (slot >= capacity) slot -= capacity;
+        return cells[slot];
+    }
+    const Position& front() const { return (*this)[0]; }
+    const Position& back() const { return (*this)[length - 1]; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    const_iterator begin() const { return const_iterator(cells, capacity, headIndex, 0); }
+    const_iterator end() const { return const_iterator(cells, capacity, headIndex, length); }
+};
+
+// Fixed-size bit set over grid cells, 64 cells per word.
+class BitBoard {
+private:
+    std::vector<std::uint64_t> words;
+
+public:
+    explicit BitBoard(size_t bitCount = 0) : words((bitCount + 63) / 64, 0) {}
+    bool test(size_t i) const { return (words[i >> 6] >> (i & 63)) & 1u; }
+    void set(size_t i) { words[i >> 6] |= std::uint64_t(1) << (i & 63); }
+    void reset(size_t i) { words[i >> 6] &= ~(std::uint64_t(1) << (i & 63)); }
+    void clear() { std::fill(words.begin(), words.end(), 0); }
+    const std::uint64_t* data() const { return words.data(); }
+    size_t wordCount() const { return words.size(); }
+
+    // Calls fn(i) for every set bit i in [begin, end), in increasing order.
+    // Cost is one word per 64 bits scanned plus one call per set bit.
+    template <typename Fn>
+    void forEachSet(size_t begin, size_t end, Fn fn) const {
+        if (begin >= end) return;
+        const size_t first = begin >> 6;
+        const size_t last = (end - 1) >> 6;
+        for (size_t w = first; w <= last; ++w) {
+            std::uint64_t bits = words[w];
+            if (w == first) bits &= ~std::uint64_t(0) << (begin & 63);
+            if (w == last) bits &= ~std::uint64_t(0) >> (63 - ((end - 1) & 63));
+            while (bits) {
+                fn((w << 6) + lowestBit(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+private:
+    static size_t lowestBit(std::uint64_t v) {
+#if defined(__GNUC__)
+        return static_cast<size_t>(__builtin_ctzll(v));
+#else
+        size_t n = 0;
+        while (!(v & 1)) { v >>= 1; ++n; }
+        return n;
+#endif
+    }
+};
+
+// Set of free grid cells with O(1) insert, erase and uniform random pick.
+// Cells live in a dense array; slotOf maps a cell index back to its slot.
+class FreeCellSet {
+private:
+    std::vector<int> cells;
+    std::vector<int> slotOf;    // -1 when the cell is not free
+    size_t count = 0;
+
+public:
+    explicit FreeCellSet(size_t cellCount);
+    void fill();
+    void insert(int cell);
+    void erase(int cell);
+    // Inverse of erase(): puts cell back in the slot it was erased from and
+    // moves the cell erase() moved there back to the end
+    void insertAt(int cell, size_t slot);
+    bool contains(int cell) const { return slotOf[cell] >= 0; }
+    int at(size_t slot) const { return cells[slot]; }
+    int slot(int cell) const { return slotOf[cell]; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+};
+
+// Snake body stored in a fixed-capacity ring buffer sized to the grid, with a
+// per-cell occupancy map and free-cell set kept in sync as the head is pushed
+// and the tail popped. move(), grow() and checkSelfCollision() are O(1) and
+// never reallocate.
+class Snake {
+private:
+    int gridWidth;
+    int gridHeight;
+    std::vector<Position> ring;   // capacity == gridWidth * gridHeight
+    size_t headIndex = 0;
+    size_t length = 0;
+    BitBoard occupied;            // one bit per grid cell
+    FreeCellSet freeCells;        // complement of occupied, for fruit placement
+    Position lastTail;            // tail removed by the latest move(), restored by grow()
+    bool selfCollision = false;
+    Direction direction;
+    Direction nextDirection;
+
+    bool inBounds(const Position& pos) const {
+        return pos.x >= 0 && pos.x < gridWidth && pos.y >= 0 && pos.y < gridHeight;
+    }
+    size_t cellIndex(const Position& pos) const { return static_cast<size_t>(pos.y) * gridWidth + pos.x; }
+    void pushHead(const Position& pos);
+    void pushTail(const Position& pos);
+    Position popTail();
+    
+public:
+    Snake(int gridWidth, int gridHeight);
+    void move();
+    void grow();
+    // Inverse of the latest move() and grow(); see StepUndo
+    void unmove(const StepUndo& undo);
+    void setDirection(Direction dir);
+    bool checkSelfCollision() const { return selfCollision; }
+    bool occupies(const Position& pos) const { return inBounds(pos) && occupied.test(cellIndex(pos)); }
+    SnakeBody getBody() const { return SnakeBody(ring.data(), ring.size(), headIndex, length); }
+    const Position& getHead() const { return ring[headIndex]; }
+    size_t getLength() const { return length; }
+    const FreeCellSet& getFreeCells() const { return freeCells; }
+    const BitBoard& getOccupancy() const { return occupied; }
+    int getGridWidth() const { return gridWidth; }
+    Direction getDirection() const { return direction; }
+    // Cell the tail left on the latest move(); equals the tail after grow()
+    const Position& getLastTail() const { return lastTail; }
+    void reset();
+};
+
+// Small deterministic RNG (splitmix64). Unlike std::mt19937 plus
+// std::uniform_int_distribution its output is identical on every standard
+// library, so a seed reproduces the same game everywhere.
+class SimRng {
+private:
+    std::uint64_t state;
+
+public:
+    explicit SimRng(std::uint64_t seed = 0) : state(seed) {}
+    void seed(std::uint64_t s) { state = s; }
+    std::uint64_t getState() const { return state; }
+
+    std::uint64_t next() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform integer in [0, bound) without modulo bias (Lemire's method).
+    std::uint32_t below(std::uint32_t bound) {
+        std::uint64_t m = (next() >> 32) * bound;
+        std::uint32_t low = static_cast<std::uint32_t>(m);
+        if (low < bound) {
+            std::uint32_t threshold = static_cast<std::uint32_t>(-bound) % bound;
+            while (low < threshold) {
+                m = (next() >> 32) * bound;
+                low = static_cast<std::uint32_t>(m);
+            }
+        }
+        return static_cast<std::uint32_t>(m >> 32);
+    }
+};
+
+class Fruit {
+private:
+    Position position;
+    SimRng rng;
+    
+public:
+    explicit Fruit(std::uint64_t seed = 0) : rng(seed) {}
+    void reseed(std::uint64_t seed) { rng.seed(seed); }
+    std::uint64_t getRngState() const { return rng.getState(); }
+    // Puts the fruit back as it was before a respawn()
+    void restore(const Position& pos, std::uint64_t rngState) { position = pos; rng.seed(rngState); }
+    // Places the fruit on a uniformly random free cell in O(1).
+    // Returns false when the snake covers the whole board.
+    bool respawn(const Snake& snake);
+    const Position& getPosition() const { return position; }
+};
+
+struct InputStats {
+    std::uint64_t applied = 0;      // turns consumed by a tick
+    std::uint64_t dropped = 0;      // reversals, or presses with the queue full
+    std::uint64_t coalesced = 0;    // repeats of the direction already queued
+};
+
+// Small bounded FIFO of player turns, one consumed per tick, so two quick
+// presses inside one tick (e.g. Up then Left) both take effect. Each entry is
+// validated against the last queued direction rather than the current one.
+class InputQueue {
+private:
+    static const size_t CAPACITY = 3;
+    Direction items[CAPACITY] = {};
+    size_t first = 0;
+    size_t count = 0;
+    InputStats stats;
+
+public:
+    // current is the direction the snake moved on its latest tick
+    bool push(Direction dir, Direction current);
+    bool pop(Direction& dir);
+    void clear() { first = 0; count = 0; }
+    void resetStats() { stats = InputStats(); }
+    size_t size() const { return count; }
+    const InputStats& getStats() const { return stats; }
+};
+
+enum class StepResult {
+    MOVED,
+    ATE,
+    HIT_WALL,
+    HIT_SELF,
+    WON         // ate the last free cell
+};
+
+// One game of snake. Game drives it from the SFML loop; headless tools step
+// it directly.
+class SnakeSim {
+private:
+    int gridWidth;
+    int gridHeight;
+    Snake snake;
+    Fruit fruit;
+    InputQueue inputs;
+    std::uint64_t seed;
+    std::uint64_t ticks;
+    int score;
+    float gameSpeed;
+    bool over;
+    StepResult outcome;     // result of the tick that ended the game
+    StepResult advance(StepUndo* undo);
+
+public:
+    static constexpr float BASE_SPEED = 150.0f; // milliseconds per move
+    static constexpr float SPEED_INCREASE = 5.0f;
+    static constexpr float MIN_SPEED = 50.0f;
+    static constexpr int FRUIT_SCORE = 10;
+    static constexpr int DEFAULT_GRID_WIDTH = 40;
+    static constexpr int DEFAULT_GRID_HEIGHT = 30;
+
+    SnakeSim(int gridWidth, int gridHeight, std::uint64_t seed = 0);
+    void reset(std::uint64_t newSeed);
+    // Turns immediately (applied on the next tick), replacing any earlier
+    // call in the same tick. Used by bots and replays.
+    void setDirection(Direction dir) { snake.setDirection(dir); }
+    // Queues a player turn; each tick consumes at most one queued turn.
+    bool queueDirection(Direction dir) { return inputs.push(dir, snake.getDirection()); }
+    const InputStats& getInputStats() const { return inputs.getStats(); }
+    // Advances one tick, first applying the oldest queued turn if any. Once
+    // the game is over it keeps returning the final outcome without
+    // changing state.
+    StepResult step() { return advance(nullptr); }
+    StepResult step(Direction dir) { setDirection(dir); return step(); }
+    // As step(), also filling undo with what the tick overwrote. Leaves
+    // undo alone when the game is already over.
+    StepResult step(StepUndo& undo) { return advance(&undo); }
+    // Takes back the tick that undo was filled by; it must be the latest
+    // one. Queued turns are dropped.
+    void unstep(const StepUndo& undo);
+
+    bool isValidPosition(const Position& pos) const {
+        return pos.x >= 0 && pos.x < gridWidth && pos.y >= 0 && pos.y < gridHeight;
+    }
+    const Snake& getSnake() const { return snake; }
+    const Fruit& getFruit() const { return fruit; }
+    int getGridWidth() const { return gridWidth; }
+    int getGridHeight() const { return gridHeight; }
+    std::uint64_t getSeed() const { return seed; }
+    std::uint64_t getTicks() const { return ticks; }
+    int getScore() const { return score; }
+    float getGameSpeed() const { return gameSpeed; }
+    bool isOver() const { return over; }
+};
@@ -0,0 +1,55 @@
+#include "TaskPool.hpp"
+#include <algorithm>
+
+// TaskPool Implementation
+TaskPool::TaskPool(unsigned threadCount) {
+    threadCount = std::max(1u, threadCount);
+    workers.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+void TaskPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+void TaskPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return jobs.empty() && running == 0; });
+}
+
+void TaskPool::workerLoop() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            ++running;
+        }
+        job();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --running;
+            if (!jobs.empty() || running) continue;
+        }
+        idle.notify_all();
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// Small fixed pool of worker threads running queued jobs in FIFO order.
+// Used for background asset loading; jobs hand their results back to the
+// main thread themselves.
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TaskPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    unsigned running = 0;
+    bool stopping = false;
+    void workerLoop();
+
+public:
+    explicit TaskPool(unsigned threadCount);
+    // Drops jobs that have not started and waits for the running ones
+    ~TaskPool();
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+    void submit(std::function<void()> job);
+    // Blocks until the queue is empty and no job is running
+    void wait();
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+// Lock-free hand-off of the latest value from one producer thread to one
+// consumer thread. Three slots: the producer fills its back slot and
+// publishes it by swapping it with the middle one; the consumer swaps the
+// middle slot for its front slot when a newer one is waiting. Neither side
+// ever waits for the other. The consumer sees the newest value published
+// and skips any it was too slow for. Slots are reused, so values that own
+// buffers stop allocating once those buffers have grown.
+
+#include <atomic>
+
+template <typename T>
+class TripleBuffer {
+private:
+    static const unsigned FRESH = 4;    // set on middle when published and not yet taken
+
+    T slots[3];
+    std::atomic<unsigned> middle{1};
+    unsigned back = 0;                  // producer only
+    unsigned front = 2;                 // consumer only
+
+public:
+    // Producer: the slot to fill. It holds an older value, not a blank one.
+    T& write() { return slots[back]; }
+    void publish() { back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & 3; }
+
+    // Consumer: takes the newest published value if there is one. Returns
+    // whether read() changed.
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & 3;
+        return true;
+    }
+    const T& read() const { return slots[front]; }
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+// Minimal work-stealing parallel loop for independent, index-addressed jobs.
+//
+// Each worker starts with an equal contiguous share of [0, count) packed into
+// one atomic word (begin in the high 32 bits, end in the low 32 bits). Owners
+// pop from the front one index at a time; an idle worker steals the back half
+// of the fullest-looking victim with a single CAS. Ranges sit on their own
+// cache lines so owners never false-share with each other.
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace detail {
+
+struct alignas(64) StealRange {
+    std::atomic<std::uint64_t> packed{0};
+
+    static std::uint64_t pack(std::uint32_t begin, std::uint32_t end) {
+        return (static_cast<std::uint64_t>(begin) << 32) | end;
+    }
+    static std::uint32_t beginOf(std::uint64_t v) { return static_cast<std::uint32_t>(v >> 32); }
+    static std::uint32_t endOf(std::uint64_t v) { return static_cast<std::uint32_t>(v); }
+
+    // Owner side: take the next index from the front.
+    bool pop(std::uint32_t& index) {
+        std::uint64_t v = packed.load(std::memory_order_relaxed);
+        while (beginOf(v) < endOf(v)) {
+            if (packed.compare_exchange_weak(v, pack(beginOf(v) + 1, endOf(v)), std::memory_order_acq_rel)) {
+                index = beginOf(v);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Thief side: detach the back half, returned as [begin, end).
+    bool steal(std::uint32_t& begin, std::uint32_t& end) {
+        std::uint64_t v = packed.load(std::memory_order_relaxed);
+        while (beginOf(v) < endOf(v)) {
+            std::uint32_t mid = beginOf(v) + (endOf(v) - beginOf(v)) / 2;
+            if (packed.compare_exchange_weak(v, pack(beginOf(v), mid), std::memory_order_acq_rel)) {
+                begin = mid;
+                end = endOf(v);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::uint32_t remaining() const {
+        std::uint64_t v = packed.load(std::memory_order_relaxed);
+        return endOf(v) - beginOf(v);
+    }
+};
+
+} // namespace detail
+
+// Runs fn(worker, index) exactly once for every index in [0, count), using
+// `threads` workers (worker 0 is the calling thread). count must fit in 32 bits.
+template <typename Fn>
+void parallelFor(std::size_t count, unsigned threads, Fn&& fn) {
+    if (threads == 0) threads = 1;
+    std::vector<detail::StealRange> ranges(threads);
+    for (unsigned w = 0; w < threads; ++w) {
+        std::uint32_t begin = static_cast<std::uint32_t>(count * w / threads);
+        std::uint32_t end = static_cast<std::uint32_t>(count * (w + 1) / threads);
+        ranges[w].packed.store(detail::StealRange::pack(begin, end), std::memory_order_relaxed);
+    }
+
+    auto worker = [&](unsigned self) {
+        std::uint32_t index;
+        for (;;) {
+            while (ranges[self].pop(index)) {
+                fn(self, static_cast<std::size_t>(index));
+            }
+            // Out of local work: steal from the victim with the most left.
+            unsigned victim = self;
+            std::uint32_t most = 0;
+            for (unsigned i = 1; i < threads; ++i) {
+                unsigned candidate = (self + i) % threads;
+                std::uint32_t left = ranges[candidate].remaining();
+                if (left > most) {
+                    most = left;
+                    victim = candidate;
+                }
+            }
+            std::uint32_t begin, end;
+            if (victim == self || !ranges[victim].steal(begin, end)) {
+                if (most == 0) return;  // nothing left anywhere
+                continue;               // lost a race, rescan
+            }
+            // Our range is empty, so nobody else can be modifying it.
+            ranges[self].packed.store(detail::StealRange::pack(begin, end), std::memory_order_release);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned w = 1; w < threads; ++w) {
+        pool.emplace_back(worker, w);
+    }
+    worker(0);
+    for (auto& t : pool) {
+        t.join();
+    }
+}
@@ -0,0 +1,120 @@
+// snake_arena: steps a many-snake Arena and reports how tick throughput
+// scales with the number of snakes and threads.
+//
+//   snake_arena [--snakes N] [--threads T] [--ticks K] [--seed S]
+//               [--policy greedy|random] [--sweep]
+//
+// Without --snakes it runs 1, 10, 100, 1000 and 10000 snakes, each on a
+// board of Arena::sideFor(N) squared with one fruit per two snakes. --sweep
+// repeats every size at 1, 2, 4, ... threads up to T. The checksum column
+// is the board after the last tick; it is the same for every thread count.
+
+#include "Arena.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct ArenaOptions {
+    std::vector<std::size_t> snakeCounts = { 1, 10, 100, 1000, 10000 };
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::uint64_t ticks = 1000;
+    std::uint64_t seed = 1;
+    ArenaPolicy policy = ArenaPolicy::GREEDY;
+    bool sweep = false;
+};
+
+struct RunResult {
+    Arena::Stats stats;
+    std::size_t alive = 0;
+    std::uint64_t checksum = 0;
+    double seconds = 0.0;
+};
+
+RunResult runArena(const ArenaOptions& opt, std::size_t snakes, unsigned threads) {
+    const int side = Arena::sideFor(snakes);
+    Arena arena(side, side, snakes, std::max<std::size_t>(1, snakes / 2), threads);
+    arena.setPolicy(opt.policy);
+    arena.reset(opt.seed);
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t t = 0; t < opt.ticks; ++t) arena.step();
+    auto end = std::chrono::steady_clock::now();
+
+    RunResult result;
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    result.stats = arena.getStats();
+    result.alive = arena.getAliveCount();
+    result.checksum = arena.checksum();
+    return result;
+}
+
+void printUsage() {
+    std::fprintf(stderr,
+        "usage: snake_arena [--snakes N] [--threads T] [--ticks K] [--seed S]\n"
+        "                   [--policy greedy|random] [--sweep]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ArenaOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        auto value = [&](const char* name) -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "missing value for %s\n", name);
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (!std::strcmp(argv[i], "--snakes")) opt.snakeCounts = { std::strtoull(value("--snakes"), nullptr, 10) };
+        else if (!std::strcmp(argv[i], "--threads")) opt.threads = std::max(1, std::atoi(value("--threads")));
+        else if (!std::strcmp(argv[i], "--ticks")) opt.ticks = std::strtoull(value("--ticks"), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--seed")) opt.seed = std::strtoull(value("--seed"), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--policy")) {
+            std::string policy = value("--policy");
+            if (policy != "greedy" && policy != "random") { printUsage(); return 2; }
+            opt.policy = policy == "greedy" ? ArenaPolicy::GREEDY : ArenaPolicy::RANDOM;
+        }
+        else if (!std::strcmp(argv[i], "--sweep")) opt.sweep = true;
+        else { printUsage(); return 2; }
+    }
+    if (opt.snakeCounts.front() == 0 || opt.snakeCounts.front() > 0x7FFFFFFFull) {
+        std::fprintf(stderr, "--snakes must be between 1 and 2^31 - 1\n");
+        return 2;
+    }
+
+    std::vector<unsigned> threadCounts;
+    if (opt.sweep) {
+        for (unsigned t = 1; t < opt.threads; t *= 2) threadCounts.push_back(t);
+    }
+    threadCounts.push_back(opt.threads);
+
+    std::printf("%llu ticks per run, policy %s, seed %llu\n", (unsigned long long)opt.ticks,
+                opt.policy == ArenaPolicy::GREEDY ? "greedy" : "random", (unsigned long long)opt.seed);
+    std::printf("%8s %9s %8s %10s %12s %14s %8s %26s %16s\n", "snakes", "board", "threads", "seconds",
+                "ticks/sec", "moves/sec", "alive", "deaths wall/body/head-on", "checksum");
+    for (std::size_t snakes : opt.snakeCounts) {
+        const int side = Arena::sideFor(snakes);
+        for (unsigned threads : threadCounts) {
+            RunResult r = runArena(opt, snakes, threads);
+            char board[32];
+            std::snprintf(board, sizeof(board), "%dx%d", side, side);
+            char deaths[64];
+            std::snprintf(deaths, sizeof(deaths), "%llu/%llu/%llu",
+                          (unsigned long long)r.stats.deaths[Arena::WALL],
+                          (unsigned long long)r.stats.deaths[Arena::BODY],
+                          (unsigned long long)r.stats.deaths[Arena::HEAD_ON]);
+            std::printf("%8zu %9s %8u %10.3f %12.0f %14.0f %8zu %26s %016llx\n",
+                        snakes, board, threads, r.seconds, r.stats.ticks / r.seconds,
+                        r.stats.moves / r.seconds, r.alive, deaths, (unsigned long long)r.checksum);
+        }
+    }
+    return 0;
+}
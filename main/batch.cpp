@@ -0,0 +1,342 @@
+// snake_batch: runs many independent headless games across all cores and
+// reports aggregate statistics and throughput.
+//
+//   snake_batch [--games N] [--threads T] [--seed S] [--policy greedy|random|autopilot]
+//               [--max-ticks K] [--backend sim|soa] [--sweep]
+//
+// Game i is seeded from (seed, i) only, so results are identical for any
+// thread count. --sweep repeats the run at 1, 2, 4, ... threads up to T.
+// --backend soa steps games lane-parallel through SimBatch (greedy policy
+// only); it plays the same games as the default SnakeSim backend.
+// --policy autopilot also reports the planner's time per tick; the "won"
+// death cause is its completion rate.
+
+#include "SnakeSim.hpp"
+#include "Bots.hpp"
+#include "Autopilot.hpp"
+#include "SimBatch.hpp"
+#include "WorkStealing.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+enum DeathCause { WALL, SELF, WON, TIMEOUT, CAUSE_COUNT };
+const char* const CAUSE_NAMES[CAUSE_COUNT] = { "wall", "self", "won", "timeout" };
+
+const int TICK_BUCKETS = 32; // log2 buckets
+
+struct BatchOptions {
+    std::size_t games = 100000;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::uint64_t seed = 1;
+    std::string policy = "greedy";
+    std::uint64_t maxTicks = 0; // 0 = 100 ticks per board cell (1000 for autopilot)
+    bool soa = false;
+    bool sweep = false;
+};
+
+// Games handed to one SimBatch at a time; lanes that finish early pick up
+// the next game of the block.
+const std::size_t SOA_BLOCK_GAMES = 256;
+const std::size_t SOA_LANES = 64;
+
+// Per-thread accumulators. Each worker writes only its own instance, which
+// is cache-line aligned, and the totals are merged after the threads join.
+struct alignas(64) WorkerStats {
+    std::uint64_t games = 0;
+    std::uint64_t ticks = 0;
+    std::uint64_t totalScore = 0;
+    std::uint64_t totalLength = 0;
+    int maxScore = 0;
+    std::size_t maxLength = 0;
+    std::uint64_t causes[CAUSE_COUNT] = {};
+    std::vector<std::uint64_t> fruitHistogram;  // indexed by fruits eaten
+    std::uint64_t tickHistogram[TICK_BUCKETS] = {};
+    AutopilotStats autopilot;
+
+    void merge(const WorkerStats& other) {
+        games += other.games;
+        ticks += other.ticks;
+        totalScore += other.totalScore;
+        totalLength += other.totalLength;
+        maxScore = std::max(maxScore, other.maxScore);
+        maxLength = std::max(maxLength, other.maxLength);
+        for (int c = 0; c < CAUSE_COUNT; ++c) causes[c] += other.causes[c];
+        if (fruitHistogram.size() < other.fruitHistogram.size()) {
+            fruitHistogram.resize(other.fruitHistogram.size(), 0);
+        }
+        for (std::size_t i = 0; i < other.fruitHistogram.size(); ++i) fruitHistogram[i] += other.fruitHistogram[i];
+        for (int b = 0; b < TICK_BUCKETS; ++b) tickHistogram[b] += other.tickHistogram[b];
+        autopilot.merge(other.autopilot);
+    }
+};
+
+std::uint64_t gameSeed(std::uint64_t base, std::size_t index) {
+    SimRng mix(base ^ (static_cast<std::uint64_t>(index) * 0xD1B54A32D192ED03ull));
+    return mix.next();
+}
+
+int log2Bucket(std::uint64_t v) {
+    int b = 0;
+    while (v > 1 && b < TICK_BUCKETS - 1) { v >>= 1; ++b; }
+    return b;
+}
+
+void recordGame(WorkerStats& stats, bool over, StepResult result, int score, std::size_t length, std::uint64_t ticks) {
+    DeathCause cause = TIMEOUT;
+    if (over) {
+        cause = result == StepResult::HIT_WALL ? WALL : result == StepResult::HIT_SELF ? SELF : WON;
+    }
+    ++stats.games;
+    stats.ticks += ticks;
+    stats.totalScore += score;
+    stats.totalLength += length;
+    stats.maxScore = std::max(stats.maxScore, score);
+    stats.maxLength = std::max(stats.maxLength, length);
+    ++stats.causes[cause];
+    ++stats.fruitHistogram[score / SnakeSim::FRUIT_SCORE];
+    ++stats.tickHistogram[log2Bucket(ticks)];
+}
+
+template <typename Bot>
+void playGame(SnakeSim& sim, Bot& bot, std::uint64_t maxTicks, WorkerStats& stats) {
+    StepResult result = StepResult::MOVED;
+    while (!sim.isOver() && sim.getTicks() < maxTicks) {
+        result = sim.step(bot.choose(sim));
+    }
+    recordGame(stats, sim.isOver(), result, sim.getScore(), sim.getSnake().getLength(), sim.getTicks());
+}
+
+// Lane-parallel worker state for the soa backend
+struct SoaWorker {
+    SimBatch batch;
+    std::vector<SimRng> bots;
+    std::vector<std::int32_t> actions;
+    std::vector<char> busy;
+
+    SoaWorker(int width, int height)
+        : batch(width, height, SOA_LANES)
+        , bots(batch.getLaneCount())
+        , actions(batch.getLaneCount(), 0)
+        , busy(batch.getLaneCount(), 0) {}
+};
+
+// Plays games [first, last) on the lanes of one SimBatch, refilling lanes as
+// their games end.
+void playBlock(SoaWorker& w, const BatchOptions& opt, std::size_t first, std::size_t last,
+               std::uint64_t maxTicks, WorkerStats& stats) {
+    SimBatch& batch = w.batch;
+    const std::size_t lanes = batch.getLaneCount();
+    std::size_t nextGame = first;
+    std::size_t running = 0;
+    auto startGame = [&](std::size_t lane) {
+        if (nextGame < last) {
+            std::uint64_t seed = gameSeed(opt.seed, nextGame++);
+            batch.reset(lane, seed);
+            w.bots[lane].seed(seed);
+            w.busy[lane] = 1;
+        } else {
+            batch.retire(lane);
+            w.busy[lane] = 0;
+        }
+    };
+    for (std::size_t lane = 0; lane < lanes; ++lane) {
+        startGame(lane);
+        running += w.busy[lane];
+    }
+    while (running > 0) {
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            w.actions[lane] = w.busy[lane] ? static_cast<std::int32_t>(batch.chooseGreedy(lane, w.bots[lane])) : 0;
+        }
+        batch.step(w.actions.data());
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            if (!w.busy[lane]) continue;
+            bool over = !batch.isAlive(lane);
+            if (!over && batch.getTicks(lane) < maxTicks) continue;
+            recordGame(stats, over, batch.getLastResult(lane), batch.getScore(lane),
+                       batch.getLength(lane), batch.getTicks(lane));
+            startGame(lane);
+            running -= !w.busy[lane];
+        }
+    }
+}
+
+struct RunResult {
+    WorkerStats totals;
+    double seconds = 0.0;
+};
+
+RunResult runBatch(const BatchOptions& opt, unsigned threads) {
+    const int width = SnakeSim::DEFAULT_GRID_WIDTH;
+    const int height = SnakeSim::DEFAULT_GRID_HEIGHT;
+    const bool greedy = opt.policy == "greedy";
+    const bool autopilot = opt.policy == "autopilot";
+    // Filling the board along the cycle takes far longer than a greedy game
+    const std::uint64_t maxTicks = opt.maxTicks ? opt.maxTicks : (autopilot ? 1000ull : 100ull) * width * height;
+
+    std::vector<WorkerStats> stats(threads);
+    // Simulators are created lazily by their own worker so their buffers are
+    // first touched (and placed) on that thread.
+    std::vector<std::unique_ptr<SnakeSim>> sims(threads);
+    std::vector<std::unique_ptr<AutopilotBot>> pilots(threads);
+    std::vector<std::unique_ptr<SoaWorker>> soaWorkers(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    if (opt.soa) {
+        std::size_t blocks = (opt.games + SOA_BLOCK_GAMES - 1) / SOA_BLOCK_GAMES;
+        parallelFor(blocks, threads, [&](unsigned worker, std::size_t block) {
+            WorkerStats& local = stats[worker];
+            if (!soaWorkers[worker]) {
+                soaWorkers[worker] = std::make_unique<SoaWorker>(width, height);
+                local.fruitHistogram.assign(static_cast<std::size_t>(width) * height + 1, 0);
+            }
+            std::size_t first = block * SOA_BLOCK_GAMES;
+            std::size_t last = std::min(opt.games, first + SOA_BLOCK_GAMES);
+            playBlock(*soaWorkers[worker], opt, first, last, maxTicks, local);
+        });
+    } else {
+        parallelFor(opt.games, threads, [&](unsigned worker, std::size_t index) {
+            WorkerStats& local = stats[worker];
+            if (!sims[worker]) {
+                sims[worker] = std::make_unique<SnakeSim>(width, height);
+                local.fruitHistogram.assign(static_cast<std::size_t>(width) * height + 1, 0);
+            }
+            SnakeSim& sim = *sims[worker];
+            std::uint64_t seed = gameSeed(opt.seed, index);
+            sim.reset(seed);
+            if (autopilot) {
+                // Unlimited time budget, so results do not depend on load
+                if (!pilots[worker]) pilots[worker] = std::make_unique<AutopilotBot>(width, height);
+                AutopilotBot& bot = *pilots[worker];
+                bot.reset();
+                playGame(sim, bot, maxTicks, local);
+                local.autopilot.merge(bot.getStats());
+                bot.resetStats();
+            } else if (greedy) {
+                GreedyBot bot(seed);
+                playGame(sim, bot, maxTicks, local);
+            } else {
+                RandomBot bot(seed);
+                playGame(sim, bot, maxTicks, local);
+            }
+        });
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    RunResult result;
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    for (const auto& s : stats) result.totals.merge(s);
+    return result;
+}
+
+void printSummary(const WorkerStats& t) {
+    double games = static_cast<double>(std::max<std::uint64_t>(t.games, 1));
+    std::printf("games: %llu  ticks: %llu\n", (unsigned long long)t.games, (unsigned long long)t.ticks);
+    std::printf("score:  mean %.2f  max %d\n", t.totalScore / games, t.maxScore);
+    std::printf("length: mean %.2f  max %zu\n", t.totalLength / games, t.maxLength);
+    std::printf("ticks:  mean %.1f\n", t.ticks / games);
+    std::printf("death causes:");
+    for (int c = 0; c < CAUSE_COUNT; ++c) {
+        std::printf("  %s %llu (%.2f%%)", CAUSE_NAMES[c], (unsigned long long)t.causes[c], 100.0 * t.causes[c] / games);
+    }
+    std::printf("\n");
+
+    // Fruits eaten, grouped into 20 equal-width buckets up to the max seen
+    std::size_t top = 0;
+    for (std::size_t i = 0; i < t.fruitHistogram.size(); ++i) if (t.fruitHistogram[i]) top = i;
+    std::size_t width = std::max<std::size_t>(1, (top + 20) / 20);
+    std::printf("fruits eaten histogram:\n");
+    for (std::size_t lo = 0; lo <= top; lo += width) {
+        std::uint64_t n = 0;
+        for (std::size_t i = lo; i < lo + width && i < t.fruitHistogram.size(); ++i) n += t.fruitHistogram[i];
+        std::printf("  %5zu-%-5zu %10llu\n", lo, lo + width - 1, (unsigned long long)n);
+    }
+    std::printf("game length histogram (ticks):\n");
+    for (int b = 0; b < TICK_BUCKETS; ++b) {
+        if (!t.tickHistogram[b]) continue;
+        std::printf("  >= %-10llu %10llu\n", 1ull << b, (unsigned long long)t.tickHistogram[b]);
+    }
+    const AutopilotStats& a = t.autopilot;
+    if (a.ticks) {
+        std::printf("autopilot: completion %.2f%%  planning mean %.2f us/tick  max %.1f us\n",
+                    100.0 * t.causes[WON] / games, a.totalNs / 1e3 / a.ticks, a.maxNs / 1e3);
+        std::printf("           searches %.2f%%  plan reused %.2f%%  fallback %.2f%% of ticks\n",
+                    100.0 * a.searches / a.ticks, 100.0 * a.reused / a.ticks, 100.0 * a.fallbacks / a.ticks);
+    }
+}
+
+void printUsage() {
+    std::fprintf(stderr,
+        "usage: snake_batch [--games N] [--threads T] [--seed S] [--policy greedy|random|autopilot]\n"
+        "                   [--max-ticks K] [--backend sim|soa] [--sweep]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BatchOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        auto value = [&](const char* name) -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "missing value for %s\n", name);
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (!std::strcmp(argv[i], "--games")) opt.games = std::strtoull(value("--games"), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--threads")) opt.threads = std::max(1, std::atoi(value("--threads")));
+        else if (!std::strcmp(argv[i], "--seed")) opt.seed = std::strtoull(value("--seed"), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--policy")) opt.policy = value("--policy");
+        else if (!std::strcmp(argv[i], "--max-ticks")) opt.maxTicks = std::strtoull(value("--max-ticks"), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--backend")) {
+            std::string backend = value("--backend");
+            if (backend != "sim" && backend != "soa") { printUsage(); return 2; }
+            opt.soa = backend == "soa";
+        }
+        else if (!std::strcmp(argv[i], "--sweep")) opt.sweep = true;
+        else { printUsage(); return 2; }
+    }
+    if ((opt.policy != "greedy" && opt.policy != "random" && opt.policy != "autopilot") ||
+        (opt.soa && opt.policy != "greedy")) {
+        printUsage();
+        return 2;
+    }
+    if (opt.games > 0xFFFFFFFFull) {
+        std::fprintf(stderr, "--games must fit in 32 bits\n");
+        return 2;
+    }
+
+    std::printf("board %dx%d, %zu games, policy %s, seed %llu, backend %s\n",
+                SnakeSim::DEFAULT_GRID_WIDTH, SnakeSim::DEFAULT_GRID_HEIGHT,
+                opt.games, opt.policy.c_str(), (unsigned long long)opt.seed,
+                opt.soa ? SimBatch::backendName() : "sim");
+
+    std::vector<unsigned> threadCounts;
+    if (opt.sweep) {
+        for (unsigned t = 1; t < opt.threads; t *= 2) threadCounts.push_back(t);
+    }
+    threadCounts.push_back(opt.threads);
+
+    RunResult last;
+    double baseRate = 0.0;
+    std::printf("%8s %10s %14s %14s %16s %10s\n", "threads", "seconds", "games/sec", "ticks/sec", "ticks/sec/thread", "scaling");
+    for (unsigned threads : threadCounts) {
+        last = runBatch(opt, threads);
+        double ticksPerSec = last.totals.ticks / last.seconds;
+        if (baseRate == 0.0) baseRate = ticksPerSec / threads;
+        std::printf("%8u %10.3f %14.0f %14.0f %16.0f %9.2fx\n",
+                    threads, last.seconds, last.totals.games / last.seconds, ticksPerSec,
+                    ticksPerSec / threads, ticksPerSec / baseRate);
+    }
+    std::printf("\n");
+    printSummary(last.totals);
+    return 0;
+}
@@ -0,0 +1,365 @@
+// snake_bench: microbenchmarks for the simulation hot paths.
+//
+//   snake_bench [--filter SUBSTR] [--samples N] [--json FILE]
+//
+// Each benchmark is run at snake lengths from 3 up to the full board. A
+// benchmark is timed in samples of many operations; the table shows the mean
+// ns/op, the p50/p90/p99 of the per-sample ns/op and heap allocations per
+// op. --json writes the same numbers for comparing runs over time.
+//
+// Built with -DSNAKE_BENCH_RENDER (make bench-render) it also times
+// Game::drawGrid/drawSnake into an off-screen render texture; that build
+// links SFML and needs a display for the game window.
+
+#include "SnakeSim.hpp"
+#include "Autopilot.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef SNAKE_BENCH_RENDER
+#include "Game.hpp"
+#endif
+
+namespace {
+
+// Counts every global operator new so benchmarks can report allocations/op
+std::size_t allocationCount = 0;
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    ++allocationCount;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int GRID_WIDTH = SnakeSim::DEFAULT_GRID_WIDTH;
+const int GRID_HEIGHT = SnakeSim::DEFAULT_GRID_HEIGHT;
+const std::size_t BOARD_CELLS = static_cast<std::size_t>(GRID_WIDTH) * GRID_HEIGHT;
+const std::size_t LENGTHS[] = { 3, 16, 64, 256, 1024, BOARD_CELLS };
+
+const double MIN_SAMPLE_NS = 50000.0; // calibrate ops per sample up to this
+
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// A Hamiltonian cycle over the board that passes through the snake's
+// starting cells heading right, so a snake can follow it at any length
+// (including the full board) without ever colliding.
+std::vector<Direction> buildCycle() {
+    static_assert(SnakeSim::DEFAULT_GRID_HEIGHT % 2 == 0, "cycle needs an even board height");
+    return hamiltonianCycle(GRID_WIDTH, GRID_HEIGHT);
+}
+
+const std::vector<Direction>& cycle() {
+    static const std::vector<Direction> table = buildCycle();
+    return table;
+}
+
+Direction cycleDirection(const Position& p) {
+    return cycle()[static_cast<std::size_t>(p.y) * GRID_WIDTH + p.x];
+}
+
+void followCycle(Snake& snake) {
+    snake.setDirection(cycleDirection(snake.getHead()));
+    snake.move();
+}
+
+Snake makeSnake(std::size_t length) {
+    Snake snake(GRID_WIDTH, GRID_HEIGHT);
+    while (snake.getLength() < length) {
+        followCycle(snake);
+        snake.grow();
+    }
+    return snake;
+}
+
+struct Benchmark {
+    std::string name;
+    std::size_t length;
+    // Called untimed before every sample
+    std::function<void()> setup;
+    // Runs the given number of operations
+    std::function<void(std::size_t)> run;
+    // Upper bound on operations per sample (0 = unbounded)
+    std::size_t maxOps = 0;
+};
+
+struct Result {
+    std::string name;
+    std::size_t length = 0;
+    std::size_t opsPerSample = 0;
+    std::size_t samples = 0;
+    double nsPerOp = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double allocsPerOp = 0.0;
+};
+
+double timeSample(const Benchmark& b, std::size_t ops, std::size_t& allocations) {
+    if (b.setup) b.setup();
+    std::size_t allocsBefore = allocationCount;
+    Clock::time_point start = Clock::now();
+    b.run(ops);
+    Clock::time_point end = Clock::now();
+    allocations += allocationCount - allocsBefore;
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    std::size_t i = static_cast<std::size_t>(p * sorted.size());
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+Result runBenchmark(const Benchmark& b, std::size_t samples) {
+    std::size_t ops = 1;
+    std::size_t ignored = 0;
+    while (timeSample(b, ops, ignored) < MIN_SAMPLE_NS && (b.maxOps == 0 || ops < b.maxOps)) {
+        ops *= 2;
+        if (b.maxOps) ops = std::min(ops, b.maxOps);
+    }
+
+    std::vector<double> perOp;
+    perOp.reserve(samples);
+    double totalNs = 0.0;
+    std::size_t allocations = 0;
+    for (std::size_t s = 0; s < samples; ++s) {
+        double ns = timeSample(b, ops, allocations);
+        totalNs += ns;
+        perOp.push_back(ns / ops);
+    }
+    std::sort(perOp.begin(), perOp.end());
+
+    Result r;
+    r.name = b.name;
+    r.length = b.length;
+    r.opsPerSample = ops;
+    r.samples = samples;
+    r.nsPerOp = totalNs / (static_cast<double>(ops) * samples);
+    r.p50 = percentile(perOp, 0.50);
+    r.p90 = percentile(perOp, 0.90);
+    r.p99 = percentile(perOp, 0.99);
+    r.allocsPerOp = static_cast<double>(allocations) / (static_cast<double>(ops) * samples);
+    return r;
+}
+
+// Benchmark state lives here so the lambdas can hold plain references
+struct SimFixtures {
+    std::vector<Snake> snakes;       // one per LENGTHS entry, following the cycle
+    std::vector<Snake> growStart;    // pristine copies for the grow benchmark
+    std::vector<Snake> growWork;
+    std::vector<Fruit> fruits;
+    std::vector<Position> probes;
+
+    SimFixtures() {
+        SimRng rng(7);
+        for (std::size_t i = 0; i < 4096; ++i) {
+            probes.emplace_back(static_cast<int>(rng.below(GRID_WIDTH)), static_cast<int>(rng.below(GRID_HEIGHT)));
+        }
+        for (std::size_t length : LENGTHS) {
+            snakes.push_back(makeSnake(length));
+            fruits.emplace_back(length);
+        }
+    }
+};
+
+const std::size_t GROW_OPS = 64;
+
+void addSimBenchmarks(SimFixtures& f, std::vector<Benchmark>& out) {
+    const std::size_t count = sizeof(LENGTHS) / sizeof(LENGTHS[0]);
+    f.growStart.reserve(count);
+    f.growWork.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::size_t length = LENGTHS[i];
+        Snake& snake = f.snakes[i];
+
+        out.push_back({ "snake.move", length, nullptr, [&snake](std::size_t ops) {
+            for (std::size_t n = 0; n < ops; ++n) followCycle(snake);
+            doNotOptimize(snake.getHead());
+        } });
+
+        // move + grow pairs starting at `length`; a full board grows into
+        // its last GROW_OPS cells instead, and the row says where it started
+        std::size_t start = std::min(length, BOARD_CELLS - GROW_OPS);
+        f.growStart.push_back(makeSnake(start));
+        f.growWork.push_back(f.growStart.back());
+        Snake& pristine = f.growStart.back();
+        Snake& work = f.growWork.back();
+        out.push_back({ "snake.grow", start, [&work, &pristine] { work = pristine; },
+            [&work](std::size_t ops) {
+                for (std::size_t n = 0; n < ops; ++n) {
+                    followCycle(work);
+                    work.grow();
+                }
+                doNotOptimize(work.getLength());
+            }, GROW_OPS });
+
+        // checkSelfCollision is a flag set by move(); the work it stands for
+        // is the occupancy probe of the new head, timed here on random cells
+        out.push_back({ "snake.checkSelfCollision", length, nullptr, [&snake, &f](std::size_t ops) {
+            std::size_t hits = 0;
+            for (std::size_t n = 0; n < ops; ++n) {
+                hits += snake.occupies(f.probes[n & 4095]);
+            }
+            hits += snake.checkSelfCollision();
+            doNotOptimize(hits);
+        } });
+
+        // A full board has no free cell, so respawn would only time its
+        // early return
+        if (length >= BOARD_CELLS) continue;
+        Fruit& fruit = f.fruits[i];
+        out.push_back({ "fruit.respawn", length, nullptr, [&fruit, &snake](std::size_t ops) {
+            for (std::size_t n = 0; n < ops; ++n) fruit.respawn(snake);
+            doNotOptimize(fruit.getPosition());
+        } });
+    }
+}
+
+void printResult(const Result& r) {
+    std::printf("%-26s %6zu %12.1f %10.1f %10.1f %10.1f %10.3f\n",
+                r.name.c_str(), r.length, r.nsPerOp, r.p50, r.p90, r.p99, r.allocsPerOp);
+}
+
+bool writeJson(const std::string& path, const std::vector<Result>& results) {
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+    std::fprintf(out, "{\n  \"board\": [%d, %d],\n  \"benchmarks\": [\n", GRID_WIDTH, GRID_HEIGHT);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(out,
+            "    {\"name\": \"%s\", \"length\": %zu, \"ns_per_op\": %.3f, \"p50_ns\": %.3f, "
+            "\"p90_ns\": %.3f, \"p99_ns\": %.3f, \"allocs_per_op\": %.6f, "
+            "\"ops_per_sample\": %zu, \"samples\": %zu}%s\n",
+            r.name.c_str(), r.length, r.nsPerOp, r.p50, r.p90, r.p99, r.allocsPerOp,
+            r.opsPerSample, r.samples, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+    return std::fclose(out) == 0;
+}
+
+void printUsage() {
+    std::fprintf(stderr, "usage: snake_bench [--filter SUBSTR] [--samples N] [--json FILE]\n");
+}
+
+} // namespace
+
+#ifdef SNAKE_BENCH_RENDER
+// Drives Game's board drawing into an off-screen target. A friend of Game.
+struct RenderBench {
+    Game game;
+    sf::RenderTexture target;
+    std::vector<SnakeSim> sims; // one per LENGTHS entry
+    Game::FrameSnapshot snapshot;
+
+    RenderBench() {
+        game.initialize();
+        // Time the textured path, not the fallback drawn while loading
+        game.finishLoadingAssets();
+        if (!game.texturesLoaded) {
+            std::fprintf(stderr, "warning: textures missing, timing the untextured fallback\n");
+        }
+        game.fillSnapshot(snapshot);
+        game.frame = &snapshot;
+        if (!target.resize({ static_cast<unsigned>(GRID_WIDTH * Game::CELL_SIZE),
+                             static_cast<unsigned>(GRID_HEIGHT * Game::CELL_SIZE) })) {
+            std::fprintf(stderr, "warning: could not create render texture\n");
+        }
+        // Follow the cycle until the snake has eaten its way to each length
+        SnakeSim sim(GRID_WIDTH, GRID_HEIGHT, 1);
+        for (std::size_t length : LENGTHS) {
+            while (sim.getSnake().getLength() < length && !sim.isOver()) {
+                sim.step(cycleDirection(sim.getSnake().getHead()));
+            }
+            sims.push_back(sim);
+        }
+    }
+
+    void drawGrid(std::size_t ops) {
+        for (std::size_t n = 0; n < ops; ++n) {
+            game.boardVertices.clear();
+            game.updateCamera();
+            game.drawGrid();
+            game.flushBoard(target);
+        }
+    }
+
+    void drawSnake(std::size_t i, std::size_t ops) {
+        game.sim = sims[i];
+        game.fillSnapshot(snapshot);
+        game.updateCamera();
+        for (std::size_t n = 0; n < ops; ++n) {
+            game.boardVertices.clear();
+            game.drawSnake();
+            game.flushBoard(target);
+        }
+    }
+
+    void add(std::vector<Benchmark>& out) {
+        out.push_back({ "game.drawGrid", 0, nullptr, [this](std::size_t ops) { drawGrid(ops); } });
+        for (std::size_t i = 0; i < sims.size(); ++i) {
+            out.push_back({ "game.drawSnake", sims[i].getSnake().getLength(), nullptr,
+                            [this, i](std::size_t ops) { drawSnake(i, ops); } });
+        }
+    }
+};
+#endif
+
+int main(int argc, char** argv) {
+    std::string filter;
+    std::string jsonPath;
+    std::size_t samples = 200;
+    for (int i = 1; i < argc; ++i) {
+        auto value = [&](const char* name) -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "missing value for %s\n", name);
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (!std::strcmp(argv[i], "--filter")) filter = value("--filter");
+        else if (!std::strcmp(argv[i], "--samples")) samples = std::max(1ull, std::strtoull(value("--samples"), nullptr, 10));
+        else if (!std::strcmp(argv[i], "--json")) jsonPath = value("--json");
+        else { printUsage(); return 2; }
+    }
+
+    SimFixtures fixtures;
+    std::vector<Benchmark> benchmarks;
+    addSimBenchmarks(fixtures, benchmarks);
+#ifdef SNAKE_BENCH_RENDER
+    RenderBench render;
+    render.add(benchmarks);
+#endif
+
+    std::printf("board %dx%d, %zu samples per benchmark\n", GRID_WIDTH, GRID_HEIGHT, samples);
+    std::printf("%-26s %6s %12s %10s %10s %10s %10s\n", "benchmark", "length", "ns/op", "p50", "p90", "p99", "allocs/op");
+    std::vector<Result> results;
+    for (const Benchmark& b : benchmarks) {
+        if (!filter.empty() && b.name.find(filter) == std::string::npos) continue;
+        results.push_back(runBenchmark(b, samples));
+        printResult(results.back());
+    }
+
+    if (!jsonPath.empty() && !writeJson(jsonPath, results)) {
+        std::fprintf(stderr, "could not write %s\n", jsonPath.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,167 @@
+// snake_envbench: drives libsnakeenv through its C interface, as a trainer
+// would, and reports env-steps per second.
+//
+//   snake_envbench [--envs N] [--threads T] [--steps K] [--size W] [--seed S] [--verify]
+//
+// Actions come from a cheap random policy that keeps going straight and
+// turns one step in eight. Only snake_env_step() is timed. --verify instead
+// plays every game alongside a SnakeSim given the same actions and checks
+// each step's reward, done flag and observation against it.
+
+#include "SnakeEnv.h"
+#include "SnakeSim.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct EnvOptions {
+    std::size_t envs = 4096;
+    int threads = 0;
+    std::uint64_t steps = 2000;
+    int size = 16;
+    std::uint64_t seed = 1;
+    bool verify = false;
+};
+
+// Straight on, with a random turn one step in eight
+void chooseActions(std::vector<SimRng>& rngs, std::vector<std::int32_t>& actions) {
+    for (std::size_t i = 0; i < actions.size(); ++i) {
+        const std::uint64_t r = rngs[i].next();
+        if ((r & 7) == 0) actions[i] = static_cast<std::int32_t>((r >> 3) & 3);
+    }
+}
+
+// Planes SnakeEnv should have written for sim, laid out as in SnakeEnv.h
+void expectedObservation(const SnakeSim& sim, std::vector<std::uint8_t>& out) {
+    const int stride = sim.getGridWidth() + 2;
+    const std::size_t plane = static_cast<std::size_t>(stride) * (sim.getGridHeight() + 2);
+    auto cell = [&](const Position& p) { return static_cast<std::size_t>(p.y + 1) * stride + p.x + 1; };
+    std::fill(out.begin(), out.end(), 0);
+    out[cell(sim.getSnake().getHead())] = 1;
+    for (const Position& p : sim.getSnake().getBody()) out[plane + cell(p)] = 1;
+    out[2 * plane + cell(sim.getFruit().getPosition())] = 1;
+    for (int y = 0; y < sim.getGridHeight() + 2; ++y) {
+        for (int x = 0; x < stride; ++x) {
+            if (x == 0 || y == 0 || x == stride - 1 || y == sim.getGridHeight() + 1) {
+                out[3 * plane + static_cast<std::size_t>(y) * stride + x] = 1;
+            }
+        }
+    }
+}
+
+int runVerify(const EnvOptions& opt, SnakeEnv* env, std::vector<std::uint64_t>& seeds, std::vector<std::uint8_t>& obs,
+              std::vector<float>& rewards, std::vector<std::uint8_t>& dones) {
+    const std::size_t obsSize = snake_env_observation_size(env);
+    std::vector<SnakeSim> sims;
+    for (std::size_t i = 0; i < opt.envs; ++i) sims.emplace_back(opt.size, opt.size, seeds[i]);
+    std::vector<SimRng> rngs;
+    for (std::size_t i = 0; i < opt.envs; ++i) rngs.emplace_back(opt.seed ^ (i * 0x9E3779B97F4A7C15ull));
+    std::vector<std::int32_t> actions(opt.envs, static_cast<std::int32_t>(Direction::RIGHT));
+    std::vector<std::uint8_t> expected(obsSize);
+    std::uint64_t mismatches = 0;
+    std::uint64_t episodes = 0;
+    for (std::uint64_t step = 0; step < opt.steps; ++step) {
+        chooseActions(rngs, actions);
+        if (snake_env_step(env, actions.data()) != 0) {
+            std::fprintf(stderr, "snake_env_step failed at step %llu\n", (unsigned long long)step);
+            return 1;
+        }
+        for (std::size_t i = 0; i < opt.envs; ++i) {
+            SnakeSim& sim = sims[i];
+            const int before = sim.getScore();
+            const StepResult result = sim.step(static_cast<Direction>(actions[i]));
+            const bool done = sim.isOver();
+            const float reward = static_cast<float>(sim.getScore() - before);
+            if (done) {
+                seeds[i] = SimRng(seeds[i]).next();
+                sim.reset(seeds[i]);
+                ++episodes;
+            }
+            expectedObservation(sim, expected);
+            if (rewards[i] != reward || (dones[i] != 0) != done ||
+                std::memcmp(expected.data(), &obs[i * obsSize], obsSize) != 0) {
+                if (mismatches++ < 5) {
+                    std::printf("game %zu step %llu: result %d, reward %.0f/%.0f, done %d/%d\n", i,
+                                (unsigned long long)step, static_cast<int>(result), rewards[i], reward, dones[i], done);
+                }
+            }
+        }
+    }
+    std::printf("verified %zu games x %llu steps (%llu episodes): %llu mismatches\n", opt.envs,
+                (unsigned long long)opt.steps, (unsigned long long)episodes, (unsigned long long)mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+void printUsage() {
+    std::fprintf(stderr, "usage: snake_envbench [--envs N] [--threads T] [--steps K] [--size W] [--seed S] [--verify]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    EnvOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        auto value = [&](const char* name) -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "missing value for %s\n", name);
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (!std::strcmp(argv[i], "--envs")) opt.envs = std::strtoull(value("--envs"), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--threads")) opt.threads = std::max(0, std::atoi(value("--threads")));
+        else if (!std::strcmp(argv[i], "--steps")) opt.steps = std::strtoull(value("--steps"), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--size")) opt.size = std::atoi(value("--size"));
+        else if (!std::strcmp(argv[i], "--seed")) opt.seed = std::strtoull(value("--seed"), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--verify")) opt.verify = true;
+        else { printUsage(); return 2; }
+    }
+
+    SnakeEnv* env = snake_env_create(opt.size, opt.size, opt.threads);
+    if (!env || opt.envs == 0) {
+        std::fprintf(stderr, "need --envs > 0 and --size between 8 and 4096\n");
+        return 2;
+    }
+    std::vector<std::uint64_t> seeds(opt.envs);
+    for (std::size_t i = 0; i < opt.envs; ++i) seeds[i] = opt.seed + i;
+    std::vector<std::uint8_t> obs(opt.envs * snake_env_observation_size(env));
+    std::vector<float> rewards(opt.envs);
+    std::vector<std::uint8_t> dones(opt.envs);
+    if (snake_env_reset(env, opt.envs, seeds.data(), obs.data(), rewards.data(), dones.data()) != 0) {
+        std::fprintf(stderr, "snake_env_reset failed\n");
+        snake_env_destroy(env);
+        return 1;
+    }
+
+    std::printf("%zu envs on %dx%d boards, %zu observation bytes each\n", opt.envs, opt.size, opt.size,
+                snake_env_observation_size(env));
+    int status = 0;
+    if (opt.verify) {
+        status = runVerify(opt, env, seeds, obs, rewards, dones);
+    } else {
+        std::vector<SimRng> rngs;
+        for (std::size_t i = 0; i < opt.envs; ++i) rngs.emplace_back(opt.seed ^ (i * 0x9E3779B97F4A7C15ull));
+        std::vector<std::int32_t> actions(opt.envs, static_cast<std::int32_t>(Direction::RIGHT));
+        std::chrono::nanoseconds stepTime{0};
+        for (std::uint64_t step = 0; step < opt.steps; ++step) {
+            chooseActions(rngs, actions);
+            const auto start = std::chrono::steady_clock::now();
+            snake_env_step(env, actions.data());
+            stepTime += std::chrono::steady_clock::now() - start;
+        }
+        SnakeEnvStats stats;
+        snake_env_get_stats(env, &stats);
+        const double seconds = std::chrono::duration<double>(stepTime).count();
+        std::printf("%llu env-steps in %.3f s: %.2f M steps/s, %.1f ns/step; %llu episodes, %llu fruits\n",
+                    (unsigned long long)stats.steps, seconds, stats.steps / seconds / 1e6, seconds * 1e9 / stats.steps,
+                    (unsigned long long)stats.episodes, (unsigned long long)stats.fruits);
+    }
+    snake_env_destroy(env);
+    return status;
+}
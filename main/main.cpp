@@ -1,9 +1,88 @@
 #include "Game.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <string>
+#include <thread>
+
+int main(int argc, char** argv) {
+    std::string replayPath;
+    std::string server;
+    std::string capturePath;
+    long captureFps = 60;
+    bool turbo = false;
+    bool autopilot = false;
+    long arenaSnakes = 0;
+    bool boardGiven = false;
+    int boardWidth = SnakeSim::DEFAULT_GRID_WIDTH;
+    int boardHeight = SnakeSim::DEFAULT_GRID_HEIGHT;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--board" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%dx%d", &boardWidth, &boardHeight) != 2 ||
+                !Game::isValidBoardSize(boardWidth, boardHeight)) {
+                std::cerr << "Error: --board expects WxH with sides from " << Game::MIN_BOARD_SIDE
+                          << " to " << Game::MAX_BOARD_SIDE << std::endl;
+                return 2;
+            }
+            boardGiven = true;
+        } else if (arg == "--arena" && i + 1 < argc) {
+            arenaSnakes = std::atol(argv[++i]);
+            if (arenaSnakes < 1 || arenaSnakes > 1000000) {
+                std::cerr << "Error: --arena expects a snake count from 1 to 1000000" << std::endl;
+                return 2;
+            }
+        } else if (arg == "--connect" && i + 1 < argc) {
+            server = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (arg == "--capture" && i + 1 < argc) {
+            capturePath = argv[++i];
+        } else if (arg == "--capture-fps" && i + 1 < argc) {
+            captureFps = std::atol(argv[++i]);
+            if (captureFps < 1 || captureFps > 1000) {
+                std::cerr << "Error: --capture-fps expects a frame rate from 1 to 1000" << std::endl;
+                return 2;
+            }
+        } else if (arg == "--turbo") {
+            turbo = true;
+        } else if (arg == "--autopilot") {
+            autopilot = true;
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--board WxH] [--autopilot] [--arena N] [--connect HOST:PORT] [--replay FILE [--turbo]] [--capture PATH [--capture-fps N]]" << std::endl;
+            return 2;
+        }
+    }
+
+    // About Arena::CELLS_PER_SNAKE cells per snake unless --board says otherwise
+    if (arenaSnakes && !boardGiven) {
+        boardWidth = boardHeight = std::clamp(Arena::sideFor(static_cast<std::size_t>(arenaSnakes)),
+                                              Game::MIN_BOARD_SIDE, Game::MAX_BOARD_SIDE);
+    }
+    // The game gives the arena one fruit per two snakes
+    if (arenaSnakes && !Arena::fits(boardWidth, boardHeight, static_cast<std::size_t>(arenaSnakes),
+                                    static_cast<std::size_t>(arenaSnakes) / 2)) {
+        std::cerr << "Error: --arena " << arenaSnakes << " snakes and their fruit do not fit on a "
+                  << boardWidth << "x" << boardHeight << " board" << std::endl;
+        return 2;
+    }
 
-int main() {
     try {
-        Game game;
+        Game game(boardWidth, boardHeight);
+        if (!replayPath.empty() && !game.loadReplay(replayPath, turbo)) {
+            return 1;
+        }
+        if (!server.empty() && replayPath.empty() && !arenaSnakes && !game.connect(server)) {
+            return 1;
+        }
+        if (arenaSnakes && replayPath.empty()) {
+            game.setArena(static_cast<std::size_t>(arenaSnakes), std::max(1u, std::thread::hardware_concurrency()));
+        }
+        game.setAutopilot(autopilot);
+        if (!capturePath.empty() && !game.startCapture(capturePath, static_cast<unsigned>(captureFps))) {
+            return 1;
+        }
         game.run();
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
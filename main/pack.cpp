@@ -0,0 +1,119 @@
+// snake_pack: packs the loose assets/ directory into one bundle that the
+// game memory-maps at launch.
+//
+//   snake_pack [--assets DIR] [--out FILE]
+//
+// Sprites are pre-scaled to the atlas tile size and the background to the
+// window it covers, sound effects are decoded to 16-bit PCM, and fonts and
+// the streamed music track are stored as-is.
+
+#include "AssetBundle.hpp"
+#include "Assets.hpp"
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool packImage(AssetBundleWriter& out, const std::string& path, const char* name, bool background) {
+    sf::Image image;
+    if (!image.loadFromFile(path)) return false;
+    sf::Vector2u size = background ? assets::backgroundSize(image.getSize())
+                                   : sf::Vector2u(assets::TILE_SIZE, assets::TILE_SIZE);
+    if (size != image.getSize()) image = assets::scaleImage(image, size);
+    out.add(name, AssetBundle::IMAGE, image.getPixelsPtr(), static_cast<std::uint64_t>(size.x) * size.y * 4,
+            size.x, size.y);
+    std::printf("  %-28s %ux%u RGBA\n", name, size.x, size.y);
+    return true;
+}
+
+bool packSound(AssetBundleWriter& out, const std::string& base, const char* name) {
+    sf::SoundBuffer buffer;
+    for (const char* ext : { ".wav", ".ogg", ".mp3" }) {
+        if (!buffer.loadFromFile(base + ext)) continue;
+        if (buffer.getChannelCount() > 2) {
+            std::fprintf(stderr, "warning: %s%s has %u channels; only mono and stereo are packed\n",
+                         base.c_str(), ext, buffer.getChannelCount());
+            return false;
+        }
+        out.add(name, AssetBundle::SAMPLES, buffer.getSamples(), buffer.getSampleCount() * sizeof(std::int16_t),
+                buffer.getChannelCount(), buffer.getSampleRate());
+        std::printf("  %-28s %llu samples, %u ch, %u Hz\n", name,
+                    (unsigned long long)buffer.getSampleCount(), buffer.getChannelCount(), buffer.getSampleRate());
+        return true;
+    }
+    return false;
+}
+
+bool packRaw(AssetBundleWriter& out, const std::string& path, const std::string& name) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    out.add(name, AssetBundle::RAW, bytes.data(), bytes.size());
+    std::printf("  %-28s %zu bytes\n", name.c_str(), bytes.size());
+    return true;
+}
+
+void printUsage() {
+    std::fprintf(stderr, "usage: snake_pack [--assets DIR] [--out FILE]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string dir = assets::ASSET_DIR;
+    std::string outPath = assets::BUNDLE_PATH;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--assets") && i + 1 < argc) dir = argv[++i];
+        else if (!std::strcmp(argv[i], "--out") && i + 1 < argc) outPath = argv[++i];
+        else { printUsage(); return 2; }
+    }
+
+    AssetBundleWriter out;
+    std::printf("packing %s into %s\n", dir.c_str(), outPath.c_str());
+    const std::string imgs = dir + "/imgs/";
+    if (!packImage(out, imgs + "bg.png", assets::BACKGROUND_IMAGE, true)) std::printf("  (no background image)\n");
+    if (!packImage(out, imgs + "head.png", assets::HEAD_IMAGE, false)) std::printf("  (no head image)\n");
+    if (!packImage(out, imgs + "body.png", assets::BODY_IMAGE, false)) std::printf("  (no body image)\n");
+    if (!packImage(out, imgs + "fruit.png", assets::FRUIT_IMAGE, false)) std::printf("  (no fruit image)\n");
+
+    const std::string audio = dir + "/audios/";
+    if (!packSound(out, audio + "eat", assets::EAT_SOUND)) std::printf("  (no eat sound)\n");
+    if (!packSound(out, audio + "gameover", assets::GAME_OVER_SOUND)) std::printf("  (no game over sound)\n");
+    if (!packSound(out, audio + "move", assets::MOVE_SOUND)) std::printf("  (no move sound)\n");
+    // Music keeps its compressed encoding and is streamed from the mapping
+    bool music = false;
+    for (const char* ext : { ".ogg", ".mp3", ".wav" }) {
+        if ((music = packRaw(out, audio + "bgmusic" + ext, assets::MUSIC))) break;
+    }
+    if (!music) std::printf("  (no background music)\n");
+
+    // Fonts in name order, which is the order F cycles through them
+    std::vector<std::filesystem::path> fonts;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir + "/ttf", ec)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".ttf") fonts.push_back(entry.path());
+    }
+    std::sort(fonts.begin(), fonts.end());
+    for (const auto& font : fonts) {
+        packRaw(out, font.string(), std::string(assets::FONT_PREFIX) + font.filename().string());
+    }
+
+    if (out.entryCount() == 0) {
+        std::fprintf(stderr, "no assets found under %s\n", dir.c_str());
+        return 1;
+    }
+    if (!out.save(outPath)) {
+        std::fprintf(stderr, "could not write %s\n", outPath.c_str());
+        return 1;
+    }
+    std::printf("wrote %zu entries to %s\n", out.entryCount(), outPath.c_str());
+    return 0;
+}
@@ -0,0 +1,248 @@
+// snake_server: dedicated, windowless game server. Each client gets its own
+// authoritative game; see NetServer.hpp and NetProtocol.hpp.
+//
+//   snake_server [--port P] [--max-clients N] [--max-board SIDE] [--max-cells N] [--seed S]
+//   snake_server --clients N [--seconds S] [--loss PERCENT] [--seed S]
+//
+// With --clients it instead runs a loopback load test: the server on one
+// thread, and N simulated clients with greedy bots and prediction on
+// another. It reports bandwidth per client and server CPU per tick.
+// --loss drops that share of datagrams in both directions.
+//
+// --max-board clamps the board a client asks for to SIDE x SIDE (64 by
+// default), and --max-cells caps the cells of all sessions' boards
+// together; a HELLO past either limit, or --max-clients, is ignored.
+
+#include "NetServer.hpp"
+#include "NetClient.hpp"
+#include "Bots.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct ServerOptions {
+    std::uint16_t port = net::DEFAULT_PORT;
+    std::size_t maxClients = 4096;
+    int maxBoard = NetServer::DEFAULT_MAX_BOARD_SIDE;
+    std::size_t maxCells = NetServer::DEFAULT_MAX_CELLS;
+    std::uint64_t seed = 0;
+    std::size_t clients = 0;    // > 0 runs the load test
+    double seconds = 10.0;
+    double lossPercent = 0.0;
+};
+
+// Server frame: wait for input for at most this long, then tick
+const int SERVER_FRAME_MS = 1;
+const auto STATS_INTERVAL = std::chrono::seconds(10);
+const auto RESTART_INTERVAL = std::chrono::milliseconds(500);
+
+std::atomic<bool> stopRequested{false};
+
+void onSignal(int) {
+    stopRequested.store(true);
+}
+
+void serve(NetServer& server, const std::atomic<bool>& stop, bool logStats) {
+    Clock::time_point nextLog = Clock::now() + STATS_INTERVAL;
+    while (!stop.load(std::memory_order_relaxed)) {
+        server.wait(SERVER_FRAME_MS);
+        server.receive();
+        const Clock::time_point now = Clock::now();
+        server.update(now);
+        if (logStats && now >= nextLog) {
+            const NetServer::Stats& s = server.getStats();
+            std::printf("sessions %zu  cells %zu  ticks %llu  out %.1f KB  in %.1f KB  cookies %llu  refused %llu\n",
+                        server.getSessionCount(), server.getCellsInUse(), (unsigned long long)s.sessionTicks,
+                        s.bytesOut / 1024.0, s.bytesIn / 1024.0, (unsigned long long)s.cookiesSent,
+                        (unsigned long long)s.hellosRefused);
+            std::fflush(stdout);
+            nextLog = now + STATS_INTERVAL;
+        }
+    }
+}
+
+// One simulated player: its predicted game, the connection and a bot
+struct LoadClient {
+    SnakeSim sim;
+    NetClient client;
+    GreedyBot bot;
+    std::uint32_t game = ~0u;
+    std::chrono::nanoseconds accumulator{0};
+    Clock::time_point restartSent;
+    std::uint64_t games = 0;
+
+    explicit LoadClient(std::uint64_t seed) : sim(SnakeSim::DEFAULT_GRID_WIDTH, SnakeSim::DEFAULT_GRID_HEIGHT), client(sim), bot(seed) {}
+
+    void update(std::chrono::nanoseconds elapsed) {
+        client.receive();
+        if (!client.isReady()) return;
+        if (client.getGame() != game) {
+            game = client.getGame();
+            accumulator = std::chrono::nanoseconds(0);
+            ++games;
+        }
+        if (sim.isOver()) {
+            // Until the new game's WELCOME arrives
+            const Clock::time_point now = Clock::now();
+            if (now - restartSent >= RESTART_INTERVAL) {
+                client.restart();
+                restartSent = now;
+            }
+            return;
+        }
+        accumulator += elapsed;
+        for (auto tick = tickDuration(); accumulator >= tick; tick = tickDuration()) {
+            if (!client.canStep()) {
+                accumulator = std::chrono::nanoseconds(0);
+                break;
+            }
+            accumulator -= tick;
+            sim.setDirection(bot.choose(sim));
+            client.step();
+        }
+    }
+
+    std::chrono::nanoseconds tickDuration() const {
+        return std::chrono::nanoseconds(static_cast<std::int64_t>(sim.getGameSpeed() * 1e6f));
+    }
+};
+
+int runLoadTest(const ServerOptions& opt) {
+    // Room for every simulated client, whatever --max-cells says
+    const std::size_t clientCells = static_cast<std::size_t>(SnakeSim::DEFAULT_GRID_WIDTH) * SnakeSim::DEFAULT_GRID_HEIGHT;
+    NetServer server(opt.clients, opt.seed, opt.maxBoard, std::max(opt.maxCells, opt.clients * clientCells));
+    if (!server.open(0)) {
+        std::fprintf(stderr, "could not open a UDP socket\n");
+        return 1;
+    }
+    const double loss = opt.lossPercent / 100.0;
+    server.simulateLoss(loss, opt.seed ^ 0x5EED);
+    std::atomic<bool> stop{false};
+    std::thread serverThread([&] { serve(server, stop, false); });
+
+    std::vector<std::unique_ptr<LoadClient>> clients;
+    clients.reserve(opt.clients);
+    const NetAddress address = NetAddress::loopback(server.port());
+    for (std::size_t i = 0; i < opt.clients; ++i) {
+        clients.push_back(std::make_unique<LoadClient>(opt.seed + i));
+        if (!clients.back()->client.connect(address, SnakeSim::DEFAULT_GRID_WIDTH, SnakeSim::DEFAULT_GRID_HEIGHT)) {
+            std::fprintf(stderr, "could not open a UDP socket for client %zu\n", i);
+            stop.store(true);
+            serverThread.join();
+            return 1;
+        }
+        clients.back()->client.simulateLoss(loss, opt.seed + i);
+    }
+
+    std::printf("load test: %zu clients on 127.0.0.1:%u for %.0f s, %.1f%% loss\n",
+                opt.clients, server.port(), opt.seconds, opt.lossPercent);
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opt.seconds));
+    Clock::time_point last = start;
+    while (!stopRequested.load()) {
+        const Clock::time_point now = Clock::now();
+        if (now >= end) break;
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last);
+        last = now;
+        for (auto& c : clients) c->update(elapsed);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (auto& c : clients) c->client.disconnect();
+    stop.store(true);
+    serverThread.join();
+
+    const NetServer::Stats& s = server.getStats();
+    NetClient::Stats totals;
+    std::uint64_t games = 0;
+    for (const auto& c : clients) {
+        const NetClient::Stats& cs = c->client.getStats();
+        totals.snapshots += cs.snapshots;
+        totals.mispredictions += cs.mispredictions;
+        totals.replayedTicks += cs.replayedTicks;
+        totals.desyncs += cs.desyncs;
+        totals.bytesOut += cs.bytesOut;
+        totals.packetsOut += cs.packetsOut;
+        games += c->games;
+    }
+    const double n = static_cast<double>(std::max<std::size_t>(opt.clients, 1));
+    const double frames = static_cast<double>(std::max<std::uint64_t>(s.frames, 1));
+    const double ticks = static_cast<double>(std::max<std::uint64_t>(s.sessionTicks, 1));
+    std::printf("sessions: %llu opened, %llu games played, %llu session ticks (%.1f ticks/s per client)\n",
+                (unsigned long long)s.sessionsOpened, (unsigned long long)games, (unsigned long long)s.sessionTicks,
+                s.sessionTicks / seconds / n);
+    std::printf("downstream: %.0f B/s per client, %.1f B per snapshot (%llu sent)\n",
+                s.bytesOut / seconds / n, s.bytesOut / static_cast<double>(std::max<std::uint64_t>(s.packetsOut, 1)),
+                (unsigned long long)s.packetsOut);
+    std::printf("upstream:   %.0f B/s per client, %.1f B per input\n", totals.bytesOut / seconds / n,
+                totals.bytesOut / static_cast<double>(std::max<std::uint64_t>(totals.packetsOut, 1)));
+    std::printf("server cpu: %.1f us per frame (max %.1f us, %llu frames), %.2f us per session tick, receive %.2f us per packet\n",
+                s.updateNs / 1e3 / frames, s.maxUpdateNs / 1e3, (unsigned long long)s.frames, s.updateNs / 1e3 / ticks,
+                s.receiveNs / 1e3 / static_cast<double>(std::max<std::uint64_t>(s.packetsIn, 1)));
+    std::printf("prediction: %llu snapshots applied, %llu reconciliations (%.2f%% of ticks), %llu ticks replayed, "
+                "%llu late turns, %llu desyncs\n",
+                (unsigned long long)totals.snapshots, (unsigned long long)totals.mispredictions,
+                100.0 * totals.mispredictions / ticks, (unsigned long long)totals.replayedTicks,
+                (unsigned long long)s.lateTurns, (unsigned long long)totals.desyncs);
+    return totals.desyncs == 0 ? 0 : 1;
+}
+
+void printUsage() {
+    std::fprintf(stderr,
+        "usage: snake_server [--port P] [--max-clients N] [--max-board SIDE] [--max-cells N] [--seed S]\n"
+        "       snake_server --clients N [--seconds S] [--loss PERCENT] [--seed S]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ServerOptions opt;
+    opt.seed = static_cast<std::uint64_t>(Clock::now().time_since_epoch().count());
+    for (int i = 1; i < argc; ++i) {
+        auto value = [&](const char* name) -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "missing value for %s\n", name);
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (!std::strcmp(argv[i], "--port")) opt.port = static_cast<std::uint16_t>(std::atoi(value("--port")));
+        else if (!std::strcmp(argv[i], "--max-clients")) opt.maxClients = std::strtoull(value("--max-clients"), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--max-board")) opt.maxBoard = std::atoi(value("--max-board"));
+        else if (!std::strcmp(argv[i], "--max-cells")) opt.maxCells = std::strtoull(value("--max-cells"), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--seed")) opt.seed = std::strtoull(value("--seed"), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--clients")) opt.clients = std::strtoull(value("--clients"), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--seconds")) opt.seconds = std::atof(value("--seconds"));
+        else if (!std::strcmp(argv[i], "--loss")) opt.lossPercent = std::atof(value("--loss"));
+        else { printUsage(); return 2; }
+    }
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    if (opt.maxBoard < NetServer::MIN_BOARD_SIDE || opt.maxBoard > NetServer::MAX_BOARD_SIDE) {
+        std::fprintf(stderr, "--max-board must be from %d to %d\n", NetServer::MIN_BOARD_SIDE, NetServer::MAX_BOARD_SIDE);
+        return 2;
+    }
+    if (opt.clients > 0) return runLoadTest(opt);
+
+    NetServer server(opt.maxClients, opt.seed, opt.maxBoard, opt.maxCells);
+    if (!server.open(opt.port)) {
+        std::fprintf(stderr, "could not listen on UDP port %u\n", opt.port);
+        return 1;
+    }
+    std::printf("snake_server listening on UDP port %u (up to %zu clients, %dx%d boards, %zu cells)\n", server.port(),
+                opt.maxClients, opt.maxBoard, opt.maxBoard, opt.maxCells);
+    std::fflush(stdout);
+    serve(server, stopRequested, true);
+    return 0;
+}